@@ -5,6 +5,7 @@ export interface SimulationRun {
   timestamp: string;
   durationSeconds: number;
   threadCount: number;
+  simdLevel?: string;
   samplesProcessed?: number;
   throughputPerSec?: number;
   result: Record<string, any>;
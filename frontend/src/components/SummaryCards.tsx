@@ -13,7 +13,7 @@ export function SummaryCards() {
         <p className="value">{option ? option.result.price.toFixed(4) : "—"}</p>
         <p className="meta">
           {option
-            ? `± ${Number(option.result.standardError ?? 0).toFixed(5)} (threads: ${option.threadCount})`
+            ? `± ${Number(option.result.standardError ?? 0).toFixed(5)} (threads: ${option.threadCount}${option.simdLevel ? `, ${option.simdLevel}` : ""})`
             : "Run a simulation"}
         </p>
       </div>
@@ -0,0 +1,373 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <Eigen/Core>
+
+#include "simd_dispatch.hpp"
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel Random Numbers:
+// As Easy as 1, 2, 3", SC'11). The output is a pure function of (key, counter), so
+// any path of any block can be generated on any thread without carrying state.
+struct Philox4x32 {
+    using Counter = std::array<std::uint32_t, 4>;
+    using Key = std::array<std::uint32_t, 2>;
+
+    static constexpr std::uint32_t kMultiplier0 = 0xD2511F53u;
+    static constexpr std::uint32_t kMultiplier1 = 0xCD9E8D57u;
+    static constexpr std::uint32_t kWeyl0 = 0x9E3779B9u;
+    static constexpr std::uint32_t kWeyl1 = 0xBB67AE85u;
+    static constexpr int kRounds = 10;
+
+    static constexpr Counter generate(Counter ctr, Key key) noexcept {
+        for (int round = 0; round < kRounds; ++round) {
+            if (round > 0) {
+                key[0] += kWeyl0;
+                key[1] += kWeyl1;
+            }
+            const std::uint64_t prod0 = static_cast<std::uint64_t>(kMultiplier0) * ctr[0];
+            const std::uint64_t prod1 = static_cast<std::uint64_t>(kMultiplier1) * ctr[2];
+            const auto hi0 = static_cast<std::uint32_t>(prod0 >> 32);
+            const auto lo0 = static_cast<std::uint32_t>(prod0);
+            const auto hi1 = static_cast<std::uint32_t>(prod1 >> 32);
+            const auto lo1 = static_cast<std::uint32_t>(prod1);
+            ctr = {hi1 ^ ctr[1] ^ key[0], lo1, hi0 ^ ctr[3] ^ key[1], lo0};
+        }
+        return ctr;
+    }
+};
+
+// Streams separate independent uses of the generator for the same (path, step).
+enum class RngStream : std::uint32_t {
+    PathShock = 0,
+    QmcScramble = 1,
+    Stratum = 2,
+};
+
+// Key derived from the user seed. The second word is a fixed tag so that seed 0
+// does not start from the all-zero key.
+constexpr Philox4x32::Key counterRngKey(unsigned int seed) noexcept {
+    return {static_cast<std::uint32_t>(seed), 0x5851F42Du};
+}
+
+// Maps two 32-bit words to a uniform in the open interval (0, 1): the top 52 bits
+// fill the mantissa of a double in [1, 2), then a half-ulp offset keeps the result
+// away from zero. Pure bit operations, so lane loops vectorize without a uint64
+// conversion instruction.
+constexpr double counterUniform(std::uint32_t hi, std::uint32_t lo) noexcept {
+    const std::uint64_t bits =
+        ((static_cast<std::uint64_t>(hi) << 32) | static_cast<std::uint64_t>(lo)) >> 12;
+    return (std::bit_cast<double>(bits | 0x3FF0000000000000ull) - 1.0) + 0x1.0p-53;
+}
+
+// Single-precision counterpart: the top 23 bits of hi, i.e. the leading bits of
+// counterUniform(hi, lo), fill a float mantissa, offset by half an ulp into (0, 1).
+constexpr float counterUniformFloat(std::uint32_t hi) noexcept {
+    return (std::bit_cast<float>((hi >> 9) | 0x3F800000u) - 1.0f) + 0x1.0p-24f;
+}
+
+namespace counter_rng_detail {
+
+// Number of Philox blocks (path pairs) transformed per batch. Every batch runs all
+// lanes so each variate goes through the same instruction sequence no matter where
+// it sits in the caller's block.
+inline constexpr std::size_t kBatchLanes = 64;
+
+inline constexpr double kLn2Hi = 6.93147180369123816490e-01;
+inline constexpr double kLn2Lo = 1.90821492927058770002e-10;
+inline constexpr double kSqrt2 = 1.41421356237309504880;
+inline constexpr double kHalfPi = 1.57079632679489661923;
+
+// Natural log for normal, positive x. Branch-free so the lane loop vectorizes:
+// x = m * 2^e with m in [sqrt(1/2), sqrt(2)), log(m) = 2 atanh((m - 1) / (m + 1)).
+inline double batchLog(double x) noexcept {
+    const auto bits = std::bit_cast<std::uint64_t>(x);
+    const auto rawExp = static_cast<std::int32_t>(bits >> 52) - 1023;
+    const double unit = std::bit_cast<double>((bits & 0x000FFFFFFFFFFFFFull) | 0x3FF0000000000000ull);
+    const std::int32_t high = unit > kSqrt2;
+    const double mant = unit * (high ? 0.5 : 1.0);
+    const double expo = static_cast<double>(rawExp + high);
+
+    const double t = (mant - 1.0) / (mant + 1.0);
+    const double t2 = t * t;
+    double series = 1.0 / 21.0;
+    series = series * t2 + 1.0 / 19.0;
+    series = series * t2 + 1.0 / 17.0;
+    series = series * t2 + 1.0 / 15.0;
+    series = series * t2 + 1.0 / 13.0;
+    series = series * t2 + 1.0 / 11.0;
+    series = series * t2 + 1.0 / 9.0;
+    series = series * t2 + 1.0 / 7.0;
+    series = series * t2 + 1.0 / 5.0;
+    series = series * t2 + 1.0 / 3.0;
+    series = series * t2 + 1.0;
+    return expo * kLn2Hi + (2.0 * t * series + expo * kLn2Lo);
+}
+
+// cos(2 pi u) and sin(2 pi u) for u in [0, 1): quarter-turn reduction to
+// |x| <= pi/4, Taylor polynomials, then a branch-free quadrant rotation.
+inline void batchSinCosTurn(double u, double& cosOut, double& sinOut) noexcept {
+    const double quarters = 4.0 * u;
+    const auto quadrant = static_cast<std::int32_t>(quarters + 0.5);
+    const double x = (quarters - static_cast<double>(quadrant)) * kHalfPi;
+    const double x2 = x * x;
+
+    double sinPoly = 1.0 - x2 / 342.0;
+    sinPoly = 1.0 - x2 / 272.0 * sinPoly;
+    sinPoly = 1.0 - x2 / 210.0 * sinPoly;
+    sinPoly = 1.0 - x2 / 156.0 * sinPoly;
+    sinPoly = 1.0 - x2 / 110.0 * sinPoly;
+    sinPoly = 1.0 - x2 / 72.0 * sinPoly;
+    sinPoly = 1.0 - x2 / 42.0 * sinPoly;
+    sinPoly = 1.0 - x2 / 20.0 * sinPoly;
+    sinPoly = 1.0 - x2 / 6.0 * sinPoly;
+    const double sinX = x * sinPoly;
+
+    double cosPoly = 1.0 - x2 / 306.0;
+    cosPoly = 1.0 - x2 / 240.0 * cosPoly;
+    cosPoly = 1.0 - x2 / 182.0 * cosPoly;
+    cosPoly = 1.0 - x2 / 132.0 * cosPoly;
+    cosPoly = 1.0 - x2 / 90.0 * cosPoly;
+    cosPoly = 1.0 - x2 / 56.0 * cosPoly;
+    cosPoly = 1.0 - x2 / 30.0 * cosPoly;
+    cosPoly = 1.0 - x2 / 12.0 * cosPoly;
+    const double cosX = 1.0 - x2 / 2.0 * cosPoly;
+
+    const bool swap = (quadrant & 1) != 0;
+    const double c = swap ? sinX : cosX;
+    const double s = swap ? cosX : sinX;
+    cosOut = ((quadrant + 1) & 2) != 0 ? -c : c;
+    sinOut = (quadrant & 2) != 0 ? -s : s;
+}
+
+// Float counterparts of batchLog and batchSinCosTurn for the single-precision
+// generator, with the series cut to float accuracy.
+inline float batchLogFloat(float x) noexcept {
+    constexpr float kLn2HiF = 0.693145752f;
+    constexpr float kLn2LoF = 1.42860677e-6f;
+    const auto bits = std::bit_cast<std::uint32_t>(x);
+    const auto rawExp = static_cast<std::int32_t>(bits >> 23) - 127;
+    const float unit = std::bit_cast<float>((bits & 0x007FFFFFu) | 0x3F800000u);
+    const std::int32_t high = unit > static_cast<float>(kSqrt2);
+    const float mant = unit * (high ? 0.5f : 1.0f);
+    const auto expo = static_cast<float>(rawExp + high);
+
+    const float t = (mant - 1.0f) / (mant + 1.0f);
+    const float t2 = t * t;
+    float series = 1.0f / 11.0f;
+    series = series * t2 + 1.0f / 9.0f;
+    series = series * t2 + 1.0f / 7.0f;
+    series = series * t2 + 1.0f / 5.0f;
+    series = series * t2 + 1.0f / 3.0f;
+    series = series * t2 + 1.0f;
+    return expo * kLn2HiF + (2.0f * t * series + expo * kLn2LoF);
+}
+
+inline void batchSinCosTurnFloat(float u, float& cosOut, float& sinOut) noexcept {
+    const float quarters = 4.0f * u;
+    const auto quadrant = static_cast<std::int32_t>(quarters + 0.5f);
+    const float x = (quarters - static_cast<float>(quadrant)) * static_cast<float>(kHalfPi);
+    const float x2 = x * x;
+
+    float sinPoly = 1.0f - x2 / 110.0f;
+    sinPoly = 1.0f - x2 / 72.0f * sinPoly;
+    sinPoly = 1.0f - x2 / 42.0f * sinPoly;
+    sinPoly = 1.0f - x2 / 20.0f * sinPoly;
+    sinPoly = 1.0f - x2 / 6.0f * sinPoly;
+    const float sinX = x * sinPoly;
+
+    float cosPoly = 1.0f - x2 / 90.0f;
+    cosPoly = 1.0f - x2 / 56.0f * cosPoly;
+    cosPoly = 1.0f - x2 / 30.0f * cosPoly;
+    cosPoly = 1.0f - x2 / 12.0f * cosPoly;
+    const float cosX = 1.0f - x2 / 2.0f * cosPoly;
+
+    const bool swap = (quadrant & 1) != 0;
+    const float c = swap ? sinX : cosX;
+    const float s = swap ? cosX : sinX;
+    cosOut = ((quadrant + 1) & 2) != 0 ? -c : c;
+    sinOut = (quadrant & 2) != 0 ? -s : s;
+}
+
+// Runs Philox over one batch of kBatchLanes consecutive path pairs in place:
+// the counters {pair lo, pair hi, step, streamWord} come back as output words.
+inline void philoxBatch(const Philox4x32::Key& key,
+                        std::size_t batch,
+                        std::size_t step,
+                        std::uint32_t streamWord,
+                        std::uint32_t* c0,
+                        std::uint32_t* c1,
+                        std::uint32_t* c2,
+                        std::uint32_t* c3) noexcept {
+    for (std::size_t lane = 0; lane < kBatchLanes; ++lane) {
+        const std::uint64_t pair = static_cast<std::uint64_t>(batch + lane);
+        c0[lane] = static_cast<std::uint32_t>(pair);
+        c1[lane] = static_cast<std::uint32_t>(pair >> 32);
+        c2[lane] = static_cast<std::uint32_t>(step);
+        c3[lane] = streamWord;
+    }
+
+    Philox4x32::Key roundKey = key;
+    for (int round = 0; round < Philox4x32::kRounds; ++round) {
+        if (round > 0) {
+            roundKey[0] += Philox4x32::kWeyl0;
+            roundKey[1] += Philox4x32::kWeyl1;
+        }
+        const std::uint32_t k0 = roundKey[0];
+        const std::uint32_t k1 = roundKey[1];
+        for (std::size_t lane = 0; lane < kBatchLanes; ++lane) {
+            const std::uint64_t prod0 = static_cast<std::uint64_t>(Philox4x32::kMultiplier0) * c0[lane];
+            const std::uint64_t prod1 = static_cast<std::uint64_t>(Philox4x32::kMultiplier1) * c2[lane];
+            const auto next0 = static_cast<std::uint32_t>(prod1 >> 32) ^ c1[lane] ^ k0;
+            const auto next2 = static_cast<std::uint32_t>(prod0 >> 32) ^ c3[lane] ^ k1;
+            c0[lane] = next0;
+            c1[lane] = static_cast<std::uint32_t>(prod1);
+            c2[lane] = next2;
+            c3[lane] = static_cast<std::uint32_t>(prod0);
+        }
+    }
+}
+
+}  // namespace counter_rng_detail
+
+// Counter word 3: the stream in the low byte, the asset index of a multi-asset
+// simulation above it. Asset 0 reproduces the single-asset variates.
+constexpr std::uint32_t counterStreamWord(RngStream stream, std::size_t asset) noexcept {
+    return static_cast<std::uint32_t>(stream) | (static_cast<std::uint32_t>(asset) << 8);
+}
+
+// Writes standard normals for paths [firstPath, firstPath + count) at one time step.
+// Paths 2k and 2k+1 share one Philox block (counter = {k lo, k hi, step,
+// counterStreamWord(stream, asset)}) through a Box-Muller transform. Philox rounds, log, sqrt and sin/cos all run over
+// fixed-width lane arrays in structure-of-arrays form so they vectorize, and the
+// function is cloned per ISA level (see simd_dispatch.hpp) so the lanes run as
+// wide as the CPU allows.
+//
+// Reproducibility contract: within one build, out[i] is bit-identical to
+// counterNormal(key, firstPath + i, step, stream, asset) for every i, independent
+// of firstPath, count, block size, the calling thread or the dispatched clone.
+RISK_SIMD_CLONES inline void fillCounterNormals(const Philox4x32::Key& key,
+                               std::size_t firstPath,
+                               std::size_t step,
+                               RngStream stream,
+                               std::size_t count,
+                               double* out,
+                               std::size_t asset = 0) noexcept {
+    using namespace counter_rng_detail;
+    constexpr std::size_t kLanes = kBatchLanes;
+
+    alignas(64) std::uint32_t c0[kLanes];
+    alignas(64) std::uint32_t c1[kLanes];
+    alignas(64) std::uint32_t c2[kLanes];
+    alignas(64) std::uint32_t c3[kLanes];
+    using LaneArray = Eigen::Array<double, static_cast<int>(kLanes), 1>;
+
+    alignas(64) double radius[kLanes];
+    alignas(64) double cosPart[kLanes];
+    alignas(64) double sinPart[kLanes];
+
+    const std::size_t endPath = firstPath + count;
+    const std::size_t pairBegin = firstPath / 2;
+    const std::size_t pairEnd = (endPath + 1) / 2;
+    const std::uint32_t streamWord = counterStreamWord(stream, asset);
+
+    for (std::size_t batch = pairBegin; batch < pairEnd; batch += kLanes) {
+        philoxBatch(key, batch, step, streamWord, c0, c1, c2, c3);
+
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            radius[lane] = -2.0 * batchLog(counterUniform(c0[lane], c1[lane]));
+            batchSinCosTurn(counterUniform(c2[lane], c3[lane]), cosPart[lane], sinPart[lane]);
+        }
+        // Eigen's packet sqrt; a plain std::sqrt loop keeps its errno branch and
+        // stays scalar unless the build uses -fno-math-errno.
+        LaneArray::MapAligned(radius) = LaneArray::MapAligned(radius).sqrt();
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            cosPart[lane] *= radius[lane];
+            sinPart[lane] *= radius[lane];
+        }
+
+        const std::size_t lanesUsed = std::min(kLanes, pairEnd - batch);
+        for (std::size_t lane = 0; lane < lanesUsed; ++lane) {
+            const std::size_t even = (batch + lane) * 2;
+            if (even >= firstPath) {
+                out[even - firstPath] = cosPart[lane];
+            }
+            if (even + 1 < endPath) {
+                out[even + 1 - firstPath] = sinPart[lane];
+            }
+        }
+    }
+}
+
+// Single-precision normals for the float path kernel, from the same Philox blocks
+// as the double overload: out[i] follows the double variate of path firstPath + i
+// to within a few float ulps, except that the uniforms keep 23 bits: the radius
+// can move by about 2^-23 / (u1 r) where u1 is small (deep tails), and
+// |out[i]| stays below 5.8.
+RISK_SIMD_CLONES inline void fillCounterNormals(const Philox4x32::Key& key,
+                               std::size_t firstPath,
+                               std::size_t step,
+                               RngStream stream,
+                               std::size_t count,
+                               float* out,
+                               std::size_t asset = 0) noexcept {
+    using namespace counter_rng_detail;
+    constexpr std::size_t kLanes = kBatchLanes;
+
+    alignas(64) std::uint32_t c0[kLanes];
+    alignas(64) std::uint32_t c1[kLanes];
+    alignas(64) std::uint32_t c2[kLanes];
+    alignas(64) std::uint32_t c3[kLanes];
+    using LaneArray = Eigen::Array<float, static_cast<int>(kLanes), 1>;
+
+    alignas(64) float radius[kLanes];
+    alignas(64) float cosPart[kLanes];
+    alignas(64) float sinPart[kLanes];
+
+    const std::size_t endPath = firstPath + count;
+    const std::size_t pairBegin = firstPath / 2;
+    const std::size_t pairEnd = (endPath + 1) / 2;
+    const std::uint32_t streamWord = counterStreamWord(stream, asset);
+
+    for (std::size_t batch = pairBegin; batch < pairEnd; batch += kLanes) {
+        philoxBatch(key, batch, step, streamWord, c0, c1, c2, c3);
+
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            radius[lane] = -2.0f * batchLogFloat(counterUniformFloat(c0[lane]));
+            batchSinCosTurnFloat(counterUniformFloat(c2[lane]), cosPart[lane], sinPart[lane]);
+        }
+        LaneArray::MapAligned(radius) = LaneArray::MapAligned(radius).sqrt();
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            cosPart[lane] *= radius[lane];
+            sinPart[lane] *= radius[lane];
+        }
+
+        const std::size_t lanesUsed = std::min(kLanes, pairEnd - batch);
+        for (std::size_t lane = 0; lane < lanesUsed; ++lane) {
+            const std::size_t even = (batch + lane) * 2;
+            if (even >= firstPath) {
+                out[even - firstPath] = cosPart[lane];
+            }
+            if (even + 1 < endPath) {
+                out[even + 1 - firstPath] = sinPart[lane];
+            }
+        }
+    }
+}
+
+// One variate through the batch kernel; see the contract on fillCounterNormals.
+// tests/counter_rng_test.cpp checks it against an independent libm Box-Muller.
+inline double counterNormal(const Philox4x32::Key& key,
+                            std::size_t path,
+                            std::size_t step,
+                            RngStream stream,
+                            std::size_t asset = 0) noexcept {
+    double value = 0.0;
+    fillCounterNormals(key, path, step, stream, 1, &value, asset);
+    return value;
+}
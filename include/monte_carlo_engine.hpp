@@ -1,13 +1,97 @@
 #pragma once
 
 #include <cstddef>
+#include <memory>
+#include <optional>
+#include <span>
 #include <vector>
 
+// One underlying of a correlated basket.
+struct AssetParams {
+    double spot = 0.0;
+    double dividendYield = 0.0;
+    double volatility = 0.0;
+    // Share of the VaR notional held in this asset.
+    double weight = 0.0;
+};
+
+// Dynamics of the single underlying.
+enum class AssetModel {
+    Gbm,
+    Heston,
+    Merton,
+};
+
+// Heston (1993): dv = kappa (theta - v) dt + xi sqrt(v) dW_v with
+// d<W_S, W_v> = rho dt. Used when MarketParams.model is Heston, in which case
+// MarketParams.volatility is ignored and paths are always stepped.
+struct HestonParams {
+    double initialVariance = 0.04;  // v0
+    double meanReversion = 1.5;     // kappa
+    double longRunVariance = 0.04;  // theta
+    double volOfVol = 0.5;          // xi
+    double correlation = -0.7;      // rho
+};
+
+// Merton (1976) jump-diffusion: GBM with MarketParams.volatility plus a compound
+// Poisson process of lognormal jumps, ln(1 + J) ~ N(jumpMean, jumpVolatility^2).
+// The drift is compensated so the discounted spot stays a martingale.
+struct MertonParams {
+    double jumpIntensity = 0.5;    // lambda, jumps per year
+    double jumpMean = -0.1;        // mean log jump
+    double jumpVolatility = 0.15;  // std. dev. of the log jump
+};
+
 struct MarketParams {
     double spot = 0.0;
     double riskFreeRate = 0.0;
     double dividendYield = 0.0;
     double volatility = 0.0;
+    // Optional basket for portfolio VaR. When non-empty, computeParametricVaR
+    // simulates these assets under riskFreeRate instead of the single spot above.
+    // correlation is the row-major N x N matrix (identity when empty).
+    std::vector<AssetParams> basket;
+    std::vector<double> correlation;
+    AssetModel model = AssetModel::Gbm;
+    HestonParams heston;
+    MertonParams merton;
+};
+
+// How paths are advanced to maturity. GBM has an exact lognormal terminal law, so
+// path-independent payoffs can draw S_T in one step; Stepped keeps the full
+// timeSteps discretisation (path-dependent products, validation runs).
+enum class PathSampling {
+    Auto,
+    Terminal,
+    Stepped,
+};
+
+// Source of the underlying uniforms. Sobol points are Owen-scrambled and turned
+// into paths with a Brownian bridge; independent scramblings (replicas) provide
+// the standard error.
+enum class RandomSequence {
+    PseudoRandom,
+    Sobol,
+    // Pseudo-random paths in groups of `strata`: the terminal shock of path j of a
+    // group is drawn from the j-th of `strata` equiprobable normal strata.
+    Stratified,
+};
+
+// Arithmetic of the GBM path kernel. Single draws float normals from the same
+// Philox counters, keeps the running shock sums in float and takes one float
+// exp per path; terminal prices are widened to double before any payoff, so
+// payoffs, moments and losses still accumulate in double, and the exact VaR
+// keeps its losses in float. Against the double kernel on the same counters a
+// terminal price moves on average by a relative
+//   delta <= 2^-24 (sigma sqrt(T) (n + 16 sqrt(n)) + |mu T| + 6 sigma sqrt(T) + 4)
+// for n steps (float sums of n shocks, the float Box-Muller variates, and the
+// float exp and spot product of a log price within six standard deviations).
+// Call and put payoffs are 1-Lipschitz in S_T, so a price moves by at most
+// delta S_0 e^{-qT}; convergenceStudy reports this bound next to the double
+// kernel's price. Float variates stop at |z| = 5.8 instead of 8.6.
+enum class PathPrecision {
+    Double,
+    Single,
 };
 
 struct SimulationConfig {
@@ -19,34 +103,160 @@ struct SimulationConfig {
     bool useControlVariate = true;
     std::size_t blockSize = 4096;
     double varConfidenceLevel = 0.99;
+    PathSampling sampling = PathSampling::Auto;
+    RandomSequence sequence = RandomSequence::PseudoRandom;
+    std::size_t qmcReplicas = 16;
+    // Single applies to single-asset GBM only.
+    PathPrecision precision = PathPrecision::Double;
+    // Stratified sampling (option pricing only). Each group of `strata` paths
+    // covers every stratum of the terminal normal once, and each group mean is
+    // one sample of the estimator, so the standard error comes from the spread
+    // of the group means. With latinHypercube the remaining Brownian-bridge
+    // normals are Latin-hypercube sampled within the group as well. Antithetic
+    // legs are dropped, blockSize is rounded up to whole groups and paths down;
+    // MonteCarloEngine::config() reports the adjusted settings.
+    std::size_t strata = 256;
+    bool latinHypercube = false;
+    // Adaptive path count (pseudo-random paths only). When a target or deadline
+    // is set, paths is the cap: paths are simulated in rounds starting with
+    // adaptiveBatch, each round sized from the error observed so far, until every
+    // estimate's standard error is within max(targetStandardError,
+    // targetRelativeError * |estimate|), the next round would overrun
+    // deadlineSeconds of wall-clock time, or the cap is reached. Rounds continue
+    // the same counter-based path sequence, so the result equals a fixed run over
+    // the number of paths reported in `scenarios`.
+    double targetStandardError = 0.0;
+    double targetRelativeError = 0.0;
+    double deadlineSeconds = 0.0;
+    std::size_t adaptiveBatch = 16384;
+    // Threads this engine may use at once on the process-wide task pool; 0 takes
+    // every pool thread. Engines that run side by side (stress jobs, dashboard
+    // requests) each get their own budget instead of a full thread team, and
+    // results do not depend on it.
+    std::size_t threads = 0;
 };
 
 struct VaRConfig {
     double percentile = 0.99;
     double notional = 1.0;
+    // Fused estimator: per-thread loss histograms built while blocks are simulated,
+    // instead of materialising every terminal price and loss.
+    bool streaming = false;
+    // Maximum VaR error in streaming mode, as a fraction of |notional|.
+    double streamingTolerance = 1e-4;
+    // Mean-shift importance sampling for deep tails (GBM, exact estimator only):
+    // the terminal shocks are shifted along the direction in which losses grow
+    // fastest, antithetic legs are dropped, and every scenario carries its
+    // likelihood ratio into a weighted quantile and shortfall.
+    bool importanceSampling = false;
+    // Size of the shift in terminal standard deviations; zero uses the normal
+    // quantile of `percentile`, which centres the sampled losses on the VaR.
+    double importanceShift = 0.0;
 };
 
 struct VaRResult {
     double percentile = 0.99;
     double valueAtRisk = 0.0;
     double expectedShortfall = 0.0;
+    // Moments of the loss distribution. Importance-sampled runs report the exact
+    // GBM moments, since weights aimed at the tail say little about the body.
     double meanLoss = 0.0;
     double lossStdDev = 0.0;
+    // Loss samples: every antithetic leg counts.
     std::size_t scenarios = 0;
+    // Paths simulated, before antithetic legs; adaptive runs report the paths
+    // actually run.
+    std::size_t basePaths = 0;
+    // Bound on |valueAtRisk - exact sample quantile|; zero when the quantile was
+    // selected exactly.
+    double errorBound = 0.0;
+    // Sampling error of valueAtRisk from the order statistics sqrt(n p (1 - p))
+    // ranks either side of the quantile (weighted tail mass under importance
+    // sampling).
+    double standardError = 0.0;
+    // (sum w)^2 / sum w^2 of the likelihood-ratio weights of the losses at or
+    // above valueAtRisk, which set the quantile's error; equals scenarios
+    // without importance sampling.
+    double effectiveSampleSize = 0.0;
+    // Threads the path kernel ran on; 1 when the run took the serial fast path.
+    std::size_t threads = 1;
+};
+
+// Payoff of an OptionConfig. Path-dependent styles are monitored at every one of
+// SimulationConfig.timeSteps dates and need stepped paths.
+enum class PayoffStyle {
+    European,
+    ArithmeticAsian,  // average of the monitored prices against the strike
+    GeometricAsian,   // geometric average against the strike
+    Barrier,          // European payoff, knocked in or out by OptionConfig.barrier
+    Lookback,         // fixed strike: call on the maximum, put on the minimum
+};
+
+enum class BarrierType {
+    UpAndOut,
+    UpAndIn,
+    DownAndOut,
+    DownAndIn,
 };
 
 struct OptionConfig {
     double strike = 1.0;
     bool isCall = true;
+    // Estimate Greeks in the pricing pass (European payoffs under GBM only).
+    bool computeGreeks = false;
+    PayoffStyle style = PayoffStyle::European;
+    // Barrier level and type for PayoffStyle::Barrier. Crossings between
+    // monitoring dates are accounted for with a Brownian-bridge correction, so
+    // the price approximates continuous monitoring.
+    double barrier = 0.0;
+    BarrierType barrierType = BarrierType::UpAndOut;
+};
+
+// Least-squares Monte Carlo settings (Longstaff & Schwartz 2001). Exercise is
+// allowed at each of the SimulationConfig.timeSteps dates after t = 0.
+struct AmericanConfig {
+    // Continuation values are regressed on 1, x, ..., x^basisDegree with x = S / K.
+    std::size_t basisDegree = 3;
+    // Fit the exercise rule on pilotPaths stored paths, then price on
+    // SimulationConfig.paths fresh paths that stream without storage. Zero stores
+    // every pricing path at every date (float32, paths x steps) and prices
+    // in-sample.
+    std::size_t pilotPaths = 32768;
+    // Cap on the stored path matrix (paths x antithetic legs x steps floats);
+    // larger requests are rejected rather than allocated.
+    std::size_t maxStoredBytes = std::size_t{256} << 20;
+};
+
+struct GreekEstimate {
+    double value = 0.0;
+    double standardError = 0.0;
+};
+
+// Single-pass sensitivities: pathwise delta, vega and rho, and a mixed
+// pathwise/likelihood-ratio gamma (the LR weight applied to the pathwise delta).
+struct OptionGreeks {
+    GreekEstimate delta;
+    GreekEstimate gamma;
+    GreekEstimate vega;
+    GreekEstimate rho;
 };
 
 struct OptionResult {
     double price = 0.0;
     double standardError = 0.0;
+    // Closed-form reference; NaN when the payoff has none under the model
+    // (arithmetic Asian, lookback, or path-dependent payoffs off GBM).
     double analyticPrice = 0.0;
     double relativeError = 0.0;
     double controlVariateWeight = 0.0;
     std::size_t scenarios = 0;
+    // Paths simulated for the price, before antithetic legs; American prices
+    // count the pricing paths, not the pilot.
+    std::size_t basePaths = 0;
+    // Set when OptionConfig.computeGreeks was requested.
+    std::optional<OptionGreeks> greeks;
+    // Threads the path kernel ran on; 1 when the run took the serial fast path.
+    std::size_t threads = 1;
 };
 
 struct ConvergencePoint {
@@ -55,25 +265,139 @@ struct ConvergencePoint {
     double absoluteError = 0.0;
     double relativeError = 0.0;
     double standardError = 0.0;
+    RandomSequence sequence = RandomSequence::PseudoRandom;
+    // Single-precision studies only: the double kernel's price for the same
+    // paths, and the bound on |price - doublePrice| from PathPrecision.
+    std::optional<double> doublePrice;
+    double precisionBound = 0.0;
 };
 
+// Per-thread scratch buffers; defined in monte_carlo_engine.cpp.
+struct SimulationWorkspace;
+
+// Simulations reuse the engine's per-thread workspaces between calls. Each call
+// leases its own set, so the const methods may run concurrently on one engine.
 class MonteCarloEngine {
 public:
     MonteCarloEngine(MarketParams market, SimulationConfig sim);
+    ~MonteCarloEngine();
+    MonteCarloEngine(MonteCarloEngine&&) noexcept;
+    MonteCarloEngine& operator=(MonteCarloEngine&&) noexcept;
 
     [[nodiscard]] VaRResult computeParametricVaR(const VaRConfig& cfg) const;
     [[nodiscard]] OptionResult priceEuropeanOption(const OptionConfig& cfg) const;
+    // Prices a chain from one set of simulated paths: every payoff is evaluated on
+    // the same terminal prices (common random numbers across strikes), each with
+    // its own control-variate regression and standard error.
+    [[nodiscard]] std::vector<OptionResult> priceEuropeanOptions(
+        std::span<const OptionConfig> options) const;
+    // Vanilla American call or put (cfg.style must be European). analyticPrice is
+    // NaN; the European price on the same paths serves as control variate.
+    // Adaptive targets apply to the pricing paths and need pilotPaths > 0.
+    [[nodiscard]] OptionResult priceAmericanOption(const OptionConfig& cfg,
+                                                   const AmericanConfig& american = {}) const;
+    // Prices cfg at every sample size from one nested simulation of the largest.
     [[nodiscard]] std::vector<ConvergencePoint> convergenceStudy(
         const OptionConfig& cfg,
         const std::vector<std::size_t>& sampleSizes) const;
 
+    // Threads one simulation of this engine may run on: the config's budget
+    // capped by the task pool size. Simulations too small to repay waking pool
+    // threads use fewer (see OptionResult::threads).
+    [[nodiscard]] std::size_t threadCount() const;
+
+    // The settings simulations run with, after the constructor's adjustments
+    // (stratified runs drop antithetic legs and round blockSize to whole groups).
+    [[nodiscard]] const SimulationConfig& config() const noexcept;
+
+    // Times the task pool's wake-up against the path kernel to set the
+    // serial/parallel crossover. Binaries call it once at startup so no request
+    // pays for the probe; otherwise the first simulation that could go parallel
+    // runs it.
+    static void calibrateThreading();
+
+    // Debug counter: heap allocations made by the engine's workspaces so far,
+    // including those leased by calls still running. It never decreases and
+    // stops growing once the buffers have reached the block size.
+    [[nodiscard]] std::size_t workspaceAllocations() const;
+
 private:
+    struct PayoffMoments;
+    struct ExerciseRule;
+    struct LossTilt;
+    struct WorkspaceCache;
+    class WorkspaceLease;
+    struct LossMoments {
+        double mean = 0.0;
+        double stdDev = 0.0;
+    };
+
     MarketParams market_;
     SimulationConfig sim_;
+    // Column-major lower Cholesky factor of market_.correlation.
+    std::vector<double> basketFactor_;
+    std::unique_ptr<WorkspaceCache> workspaceCache_;
+
+    const std::vector<std::unique_ptr<SimulationWorkspace>>& threadWorkspaces() const;
+    // Threads for simulating `paths` paths of `steps` steps: the budget, cut down
+    // to one thread per calibrated crossover's worth of path-steps.
+    std::size_t pathThreads(std::size_t paths, std::size_t steps) const;
 
-    double pathDrift() const;
-    double pathDiffusion() const;
+    std::size_t simulationSteps(bool pathIndependent) const;
+    double effectiveVolatility() const;
+    double pathDrift(std::size_t steps) const;
+    double pathDiffusion(std::size_t steps) const;
 
-    std::vector<double> simulateTerminalPrices(std::size_t basePaths) const;
+    template <typename Fn>
+    void withPathModel(std::size_t steps, Fn&& fn) const;
+    template <typename BlockFn>
+    void forEachTerminalBlock(std::size_t firstPath,
+                              std::size_t pathCount,
+                              const LossTilt* tilt,
+                              BlockFn&& onBlock) const;
+    template <typename BlockFn>
+    void forEachBasketBlock(std::size_t firstPath,
+                            std::size_t pathCount,
+                            double notional,
+                            const LossTilt* tilt,
+                            BlockFn&& onBlock) const;
+    template <typename BlockFn>
+    void forEachLossBlock(std::size_t firstPath,
+                          std::size_t pathCount,
+                          double notional,
+                          const LossTilt* tilt,
+                          BlockFn&& onBlock) const;
+    template <typename Loss>
+    void appendLosses(std::vector<Loss>& losses,
+                      std::vector<double>& weights,
+                      std::size_t firstPath,
+                      std::size_t pathCount,
+                      double notional,
+                      const LossTilt* tilt) const;
+    LossTilt lossTilt(const VaRConfig& cfg) const;
+    LossMoments nominalLossMoments(double notional) const;
+    template <typename Loss>
+    VaRResult computeExactVaR(const VaRConfig& cfg, const LossTilt* tilt) const;
+    VaRResult computeStreamingVaR(const VaRConfig& cfg) const;
+    double singlePrecisionBound(std::size_t steps) const;
+    std::size_t simulatedBasePaths() const;
+    void validateOptions(std::span<const OptionConfig> options) const;
+    double expectedControl(const OptionConfig& cfg) const;
+    ExerciseRule fitExerciseRule(const OptionConfig& cfg,
+                                 const AmericanConfig& american,
+                                 std::size_t basePaths,
+                                 PayoffMoments& inSample) const;
+    PayoffMoments streamExercise(const OptionConfig& cfg,
+                                 const ExerciseRule& rule,
+                                 std::size_t firstPath,
+                                 std::size_t pathCount) const;
+    std::vector<PayoffMoments> simulatePayoffMoments(std::span<const OptionConfig> options,
+                                                     std::size_t firstPath,
+                                                     std::size_t pathCount) const;
+    double referencePrice(const OptionConfig& cfg) const;
+    double hestonPrice(const OptionConfig& cfg) const;
+    double mertonPrice(const OptionConfig& cfg) const;
+    double geometricAsianPrice(const OptionConfig& cfg) const;
+    double barrierPrice(const OptionConfig& cfg) const;
     double blackScholesPrice(const OptionConfig& cfg) const;
 };
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+
+#include "simd_dispatch.hpp"
+
+// Path-block kernels written as Eigen expressions: the GBM terminal exp, the
+// European payoff and the basket loss transform. Eigen fixes its packet width per
+// translation unit from the compile flags, so target_clones cannot widen them;
+// instead the same kernels are compiled in one translation unit per ISA
+// (src/path_kernels_avx2.cpp with -mavx2 -mfma, src/path_kernels_avx512.cpp with
+// -mavx512f -mfma) and pathKernels() picks a table once, from detectSimdLevel().
+// A unit built without its flags reports no table, and the dispatcher falls back
+// one level.
+//
+// Every kernel runs whole batches of kPathKernelLanes values, padding the tail of
+// the block, so a value goes through the same instructions wherever it sits in the
+// block: results do not depend on the block size. Across levels they differ by a
+// few ulps, since the AVX2 and AVX-512 units evaluate exp with FMA (Eigen requires
+// -mfma alongside -mavx512f); the baseline table is the reference the tests
+// compare against.
+inline constexpr std::size_t kPathKernelLanes = 16;
+
+struct PathKernels {
+    SimdLevel level = SimdLevel::Baseline;
+
+    // out[i] = scale * exp(offset + slope * x[i]); out may alias x.
+    void (*scaledExp)(const double* x, std::size_t n, double scale, double offset, double slope, double* out);
+    // The same in float, widened to double on store.
+    void (*scaledExpFloat)(const float* x, std::size_t n, float scale, float offset, float slope, double* out);
+    // sum[i] += weight * (exp(x[i] + offset) - 1): one asset's share of a basket return.
+    void (*accumulateReturn)(const double* x, std::size_t n, double offset, double weight, double* sum);
+    // out[i] = discount * max(S[i] - K, 0) for a call, discount * max(K - S[i], 0) for a put.
+    void (*discountedIntrinsic)(const double* spot, std::size_t n, double strike, bool isCall, double discount,
+                                double* out);
+};
+
+// The table for this CPU, selected on first use.
+const PathKernels& pathKernels() noexcept;
+
+namespace path_kernels_detail {
+
+const PathKernels& baselineKernels() noexcept;
+// Null when the unit was compiled without its ISA flags.
+const PathKernels* avx2Kernels() noexcept;
+const PathKernels* avx512Kernels() noexcept;
+
+}  // namespace path_kernels_detail
@@ -0,0 +1,300 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "counter_rng.hpp"
+
+// Sobol low-discrepancy sequence with 32-bit direction numbers. Dimension 0 is the
+// van der Corput sequence; dimensions 1-20 use the primitive polynomials and initial
+// direction numbers of Joe & Kuo (new-joe-kuo-6.21201). Further dimensions take the
+// next primitive polynomials in (degree, coefficient) order with odd initial
+// direction numbers drawn from a fixed Philox stream; with a Brownian-bridge
+// construction those dimensions only drive the finest path increments.
+class SobolSequence {
+public:
+    static constexpr int kBits = 32;
+
+    explicit SobolSequence(std::size_t dimensions) : directions_(dimensions) {
+        if (dimensions == 0) {
+            throw std::invalid_argument("SobolSequence requires at least one dimension");
+        }
+        for (int k = 0; k < kBits; ++k) {
+            directions_[0][k] = std::uint32_t{1} << (kBits - 1 - k);
+        }
+
+        PolynomialCursor cursor;
+        for (std::size_t dim = 1; dim < dimensions; ++dim) {
+            int degree = 0;
+            std::uint32_t coefficients = 0;
+            std::array<std::uint32_t, kBits> initial{};
+            if (dim <= kJoeKuo.size()) {
+                const JoeKuoEntry& entry = kJoeKuo[dim - 1];
+                degree = entry.degree;
+                coefficients = entry.coefficients;
+                for (int k = 0; k < degree; ++k) {
+                    initial[k] = entry.initial[k];
+                }
+                cursor.skipPast(degree, coefficients);
+            } else {
+                cursor.next(degree, coefficients);
+                for (int k = 0; k < degree; ++k) {
+                    // Odd m_k < 2^(k+1).
+                    const Philox4x32::Counter words = Philox4x32::generate(
+                        {static_cast<std::uint32_t>(dim), static_cast<std::uint32_t>(k), 0u, 0u},
+                        kInitialKey);
+                    initial[k] = (words[0] & ((std::uint32_t{1} << (k + 1)) - 1)) | 1u;
+                }
+            }
+            buildDirections(degree, coefficients, initial, directions_[dim]);
+        }
+    }
+
+    [[nodiscard]] std::size_t dimensions() const { return directions_.size(); }
+
+    // Unscrambled coordinate of point `index` (direct, not Gray-code, ordering).
+    [[nodiscard]] std::uint32_t sample(std::uint32_t index, std::size_t dim) const {
+        const std::array<std::uint32_t, kBits>& v = directions_[dim];
+        std::uint32_t x = 0;
+        for (int k = 0; index != 0; ++k, index >>= 1) {
+            x ^= (index & 1u) != 0 ? v[k] : 0u;
+        }
+        return x;
+    }
+
+    // Nested uniform (Owen) scramble via the hash-based Laine-Karras permutation
+    // (Burley, "Practical Hash-based Owen Scrambling", JCGT 2020).
+    [[nodiscard]] static std::uint32_t owenScramble(std::uint32_t x, std::uint32_t seed) {
+        x = reverseBits(x);
+        x += seed;
+        x ^= x * 0x6C50B47Cu;
+        x ^= x * 0xB82F1E52u;
+        x ^= x * 0xC7AFE638u;
+        x ^= x * 0x8D22F6E6u;
+        return reverseBits(x);
+    }
+
+    // Scrambled coordinate mapped to the open interval (0, 1).
+    [[nodiscard]] double uniform(std::uint32_t index, std::size_t dim, std::uint32_t seed) const {
+        const std::uint32_t scrambled = owenScramble(sample(index, dim), seed);
+        return (static_cast<double>(scrambled) + 0.5) * 0x1.0p-32;
+    }
+
+private:
+    struct JoeKuoEntry {
+        int degree;
+        std::uint32_t coefficients;
+        std::array<std::uint32_t, 7> initial;
+    };
+
+    static constexpr std::array<JoeKuoEntry, 20> kJoeKuo{{
+        {1, 0, {1}},
+        {2, 1, {1, 3}},
+        {3, 1, {1, 3, 1}},
+        {3, 2, {1, 1, 1}},
+        {4, 1, {1, 1, 3, 3}},
+        {4, 4, {1, 3, 5, 13}},
+        {5, 2, {1, 1, 5, 5, 17}},
+        {5, 4, {1, 1, 5, 5, 5}},
+        {5, 7, {1, 1, 7, 11, 19}},
+        {5, 11, {1, 1, 5, 1, 1}},
+        {5, 13, {1, 1, 1, 3, 11}},
+        {5, 14, {1, 3, 5, 5, 31}},
+        {6, 1, {1, 3, 3, 9, 7, 49}},
+        {6, 13, {1, 1, 1, 15, 21, 21}},
+        {6, 16, {1, 3, 1, 13, 27, 49}},
+        {6, 19, {1, 1, 1, 15, 7, 5}},
+        {6, 22, {1, 3, 1, 15, 13, 25}},
+        {6, 25, {1, 1, 5, 5, 19, 61}},
+        {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+        {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+    }};
+
+    static constexpr Philox4x32::Key kInitialKey{0x50B01u, 0xD1EC7u};
+
+    // Enumerates primitive polynomials over GF(2) of degree >= 1 in order of
+    // (degree, middle coefficients a) as in the Joe-Kuo tables.
+    class PolynomialCursor {
+    public:
+        void skipPast(int degree, std::uint32_t coefficients) {
+            degree_ = degree;
+            coefficients_ = coefficients;
+        }
+
+        void next(int& degree, std::uint32_t& coefficients) {
+            for (;;) {
+                ++coefficients_;
+                if (coefficients_ >= (std::uint32_t{1} << (degree_ > 0 ? degree_ - 1 : 0))) {
+                    ++degree_;
+                    coefficients_ = 0;
+                }
+                if (isPrimitive(degree_, coefficients_)) {
+                    degree = degree_;
+                    coefficients = coefficients_;
+                    return;
+                }
+            }
+        }
+
+    private:
+        // Polynomial x^s + a_1 x^(s-1) + ... + a_(s-1) x + 1 as a bit mask.
+        static std::uint64_t polynomialBits(int degree, std::uint32_t coefficients) {
+            return (std::uint64_t{1} << degree) | (static_cast<std::uint64_t>(coefficients) << 1) | 1u;
+        }
+
+        static std::uint64_t mulMod(std::uint64_t a, std::uint64_t b, std::uint64_t poly, int degree) {
+            std::uint64_t result = 0;
+            while (b != 0) {
+                if ((b & 1u) != 0) {
+                    result ^= a;
+                }
+                b >>= 1;
+                a <<= 1;
+                if (((a >> degree) & 1u) != 0) {
+                    a ^= poly;
+                }
+            }
+            return result;
+        }
+
+        static std::uint64_t powMod(std::uint64_t exponent, std::uint64_t poly, int degree) {
+            std::uint64_t result = 1;
+            std::uint64_t base = 2;  // x, already reduced for degree >= 2
+            while (exponent != 0) {
+                if ((exponent & 1u) != 0) {
+                    result = mulMod(result, base, poly, degree);
+                }
+                base = mulMod(base, base, poly, degree);
+                exponent >>= 1;
+            }
+            return result;
+        }
+
+        // x has multiplicative order exactly 2^s - 1 modulo the polynomial (s >= 2).
+        static bool isPrimitive(int degree, std::uint32_t coefficients) {
+            const std::uint64_t poly = polynomialBits(degree, coefficients);
+            const std::uint64_t order = (std::uint64_t{1} << degree) - 1;
+            if (powMod(order, poly, degree) != 1) {
+                return false;
+            }
+            std::uint64_t remaining = order;
+            for (std::uint64_t factor = 2; factor * factor <= remaining; ++factor) {
+                if (remaining % factor != 0) {
+                    continue;
+                }
+                if (powMod(order / factor, poly, degree) == 1) {
+                    return false;
+                }
+                while (remaining % factor == 0) {
+                    remaining /= factor;
+                }
+            }
+            return remaining == 1 || powMod(order / remaining, poly, degree) != 1;
+        }
+
+        int degree_ = 0;
+        std::uint32_t coefficients_ = 0;
+    };
+
+    static void buildDirections(int degree,
+                                std::uint32_t coefficients,
+                                const std::array<std::uint32_t, kBits>& initial,
+                                std::array<std::uint32_t, kBits>& v) {
+        for (int k = 0; k < kBits; ++k) {
+            if (k < degree) {
+                v[k] = initial[k] << (kBits - 1 - k);
+                continue;
+            }
+            std::uint32_t value = v[k - degree] ^ (v[k - degree] >> degree);
+            for (int i = 1; i < degree; ++i) {
+                if (((coefficients >> (degree - 1 - i)) & 1u) != 0) {
+                    value ^= v[k - i];
+                }
+            }
+            v[k] = value;
+        }
+    }
+
+    static std::uint32_t reverseBits(std::uint32_t x) {
+        x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+        x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+        x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+        x = ((x >> 8) & 0x00FF00FFu) | ((x & 0x00FF00FFu) << 8);
+        return (x >> 16) | (x << 16);
+    }
+
+    std::vector<std::array<std::uint32_t, kBits>> directions_;
+};
+
+// Brownian-bridge construction over equally spaced steps (Jaeckel, "Monte Carlo
+// Methods in Finance", ch. 10). Input variate 0 sets the terminal value, later
+// variates fill successive midpoints, so the leading (best distributed) QMC
+// dimensions carry most of the path variance.
+class BrownianBridge {
+public:
+    explicit BrownianBridge(std::size_t steps)
+        : bridgeIndex_(steps),
+          leftIndex_(steps),
+          rightIndex_(steps),
+          leftWeight_(steps),
+          rightWeight_(steps),
+          stdDev_(steps) {
+        std::vector<std::size_t> map(steps, 0);
+        map[steps - 1] = 1;
+        bridgeIndex_[0] = steps - 1;
+        stdDev_[0] = std::sqrt(static_cast<double>(steps));
+        for (std::size_t i = 1, j = 0; i < steps; ++i) {
+            while (map[j] != 0) {
+                ++j;
+            }
+            std::size_t k = j;
+            while (map[k] == 0) {
+                ++k;
+            }
+            const std::size_t l = j + ((k - 1 - j) >> 1);
+            map[l] = i;
+            bridgeIndex_[i] = l;
+            leftIndex_[i] = j;
+            rightIndex_[i] = k;
+            const double span = static_cast<double>(k + 1 - j);
+            leftWeight_[i] = static_cast<double>(k - l) / span;
+            rightWeight_[i] = static_cast<double>(l + 1 - j) / span;
+            stdDev_[i] = std::sqrt(static_cast<double>(l + 1 - j) * static_cast<double>(k - l) / span);
+            j = k + 1;
+            if (j >= steps) {
+                j = 0;
+            }
+        }
+    }
+
+    [[nodiscard]] std::size_t steps() const { return bridgeIndex_.size(); }
+
+    // Maps independent normals (bridge order) to per-step standard normal
+    // increments; `increments` may alias a scratch buffer but not `normals`.
+    void transform(const double* normals, double* increments) const {
+        const std::size_t steps = bridgeIndex_.size();
+        increments[steps - 1] = stdDev_[0] * normals[0];
+        for (std::size_t i = 1; i < steps; ++i) {
+            const std::size_t j = leftIndex_[i];
+            const std::size_t k = rightIndex_[i];
+            const std::size_t l = bridgeIndex_[i];
+            const double left = j != 0 ? leftWeight_[i] * increments[j - 1] : 0.0;
+            increments[l] = left + rightWeight_[i] * increments[k] + stdDev_[i] * normals[i];
+        }
+        for (std::size_t i = steps - 1; i > 0; --i) {
+            increments[i] -= increments[i - 1];
+        }
+    }
+
+private:
+    std::vector<std::size_t> bridgeIndex_;
+    std::vector<std::size_t> leftIndex_;
+    std::vector<std::size_t> rightIndex_;
+    std::vector<double> leftWeight_;
+    std::vector<double> rightWeight_;
+    std::vector<double> stdDev_;
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+// Runtime selection of the instruction set for the lane-loop kernels. A function
+// marked RISK_SIMD_CLONES is compiled once per x86-64 microarchitecture level and
+// bound to the best clone the CPU supports when the program loads (GNU ifunc,
+// resolved from cpuid), so one binary runs AVX-512 lanes on servers that have them
+// and falls back to AVX2, SSE4.2 or the baseline build elsewhere.
+//
+// Clones are built without floating-point contraction: an FMA-capable level must
+// round every multiply and add exactly like the baseline clone, so a simulation
+// gives bit-identical results whichever clone the loader picked.
+//
+// Eigen chooses its packet width per translation unit from the build flags, so
+// clones cannot widen Eigen expressions; those kernels are built once per ISA in
+// their own units and picked from detectSimdLevel() instead (path_kernels.hpp).
+#if defined(__x86_64__) && defined(__ELF__) && defined(__GNUC__) && !defined(__clang__)
+#define RISK_SIMD_CLONES                                                                          \
+    __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "arch=x86-64-v2", "default"), \
+                   optimize("fp-contract=off")))
+#define RISK_SIMD_DISPATCH 1
+#else
+#define RISK_SIMD_CLONES
+#define RISK_SIMD_DISPATCH 0
+#endif
+
+enum class SimdLevel {
+    Baseline,  // the build's own target (SSE2 for a generic x86-64 build)
+    Sse42,     // x86-64-v2: SSE4.2, POPCNT
+    Avx2,      // x86-64-v3: AVX2, FMA, BMI2
+    Avx512,    // x86-64-v4: AVX-512 F/BW/CD/DQ/VL
+};
+
+// The clone the loader binds on this CPU; same priority order as the resolver.
+inline SimdLevel detectSimdLevel() noexcept {
+#if RISK_SIMD_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("x86-64-v4")) {
+        return SimdLevel::Avx512;
+    }
+    if (__builtin_cpu_supports("x86-64-v3")) {
+        return SimdLevel::Avx2;
+    }
+    if (__builtin_cpu_supports("x86-64-v2")) {
+        return SimdLevel::Sse42;
+    }
+#endif
+    return SimdLevel::Baseline;
+}
+
+inline const char* simdLevelName(SimdLevel level) noexcept {
+    switch (level) {
+        case SimdLevel::Avx512:
+            return "avx512";
+        case SimdLevel::Avx2:
+            return "avx2";
+        case SimdLevel::Sse42:
+            return "sse4.2";
+        case SimdLevel::Baseline:
+            break;
+    }
+    return "baseline";
+}
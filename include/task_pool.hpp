@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Process-wide work-stealing pool behind the engine's parallel loops. A loop is
+// a job of numbered tasks: the calling thread works on it as slot 0 and up to
+// budget - 1 pool workers join as slots 1, 2, ... Each slot starts on its own
+// contiguous share of the tasks and, once that runs out, steals the back half
+// of another slot's remainder. Concurrent callers share the one set of workers,
+// so N simultaneous simulations run on the pool's threads plus their callers
+// instead of N full thread teams.
+class TaskPool {
+public:
+    explicit TaskPool(std::size_t workers) {
+        threads_.reserve(workers);
+        for (std::size_t w = 0; w < workers; ++w) {
+            threads_.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~TaskPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    // The pool shared by every engine: one thread per hardware thread
+    // (OMP_NUM_THREADS in OpenMP builds), counting the caller.
+    static TaskPool& shared() {
+        static TaskPool pool(defaultConcurrency() - 1);
+        return pool;
+    }
+
+    // Threads one job can use: the workers plus its caller.
+    [[nodiscard]] std::size_t concurrency() const { return threads_.size() + 1; }
+
+    // Calls body(task, slot) once for every task in [0, tasks) on at most
+    // `budget` threads and returns when all of them have finished. The threads
+    // of one job hold distinct slots in [0, min(budget, concurrency())), so
+    // per-slot scratch needs no locking. The first exception a task throws is
+    // rethrown here after the job drains.
+    template <typename Body>
+    void parallelFor(std::size_t tasks, std::size_t budget, Body&& body) {
+        const std::size_t slots = std::min({budget, concurrency(), tasks});
+        if (slots <= 1) {
+            for (std::size_t task = 0; task < tasks; ++task) {
+                body(task, std::size_t{0});
+            }
+            return;
+        }
+
+        const auto job = std::make_shared<Job>(tasks, slots, std::ref(body));
+        {
+            std::lock_guard lock(mutex_);
+            for (std::size_t s = 1; s < slots; ++s) {
+                queue_.push_back(job);
+            }
+        }
+        wake_.notify_all();
+        job->run(0);
+        job->wait();
+        if (job->error) {
+            std::rethrow_exception(job->error);
+        }
+    }
+
+private:
+    struct Job {
+        // One slot's remaining tasks [next, end), on its own cache line.
+        struct alignas(64) Share {
+            std::mutex mutex;
+            std::size_t next = 0;
+            std::size_t end = 0;
+        };
+
+        Job(std::size_t tasks, std::size_t slots, std::function<void(std::size_t, std::size_t)> body)
+            : body(std::move(body)), shares(slots), remaining(tasks) {
+            for (std::size_t s = 0; s < slots; ++s) {
+                shares[s].next = tasks * s / slots;
+                shares[s].end = tasks * (s + 1) / slots;
+            }
+        }
+
+        bool take(std::size_t slot, std::size_t& task) {
+            Share& own = shares[slot];
+            std::lock_guard lock(own.mutex);
+            if (own.next == own.end) {
+                return false;
+            }
+            task = own.next++;
+            return true;
+        }
+
+        // Moves the back half of the next non-empty share into this slot's.
+        bool steal(std::size_t slot, std::size_t& task) {
+            for (std::size_t i = 1; i < shares.size(); ++i) {
+                Share& victim = shares[(slot + i) % shares.size()];
+                std::size_t begin = 0;
+                std::size_t end = 0;
+                {
+                    std::lock_guard lock(victim.mutex);
+                    const std::size_t left = victim.end - victim.next;
+                    if (left == 0) {
+                        continue;
+                    }
+                    begin = victim.end - (left + 1) / 2;
+                    end = victim.end;
+                    victim.end = begin;
+                }
+                task = begin;
+                Share& own = shares[slot];
+                std::lock_guard lock(own.mutex);
+                own.next = begin + 1;
+                own.end = end;
+                return true;
+            }
+            return false;
+        }
+
+        void run(std::size_t slot) {
+            std::size_t task = 0;
+            while (take(slot, task) || steal(slot, task)) {
+                try {
+                    body(task, slot);
+                } catch (...) {
+                    std::lock_guard lock(doneMutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+                if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    std::lock_guard lock(doneMutex);
+                    done.notify_all();
+                }
+            }
+        }
+
+        void wait() {
+            std::unique_lock lock(doneMutex);
+            done.wait(lock, [this] { return remaining.load(std::memory_order_acquire) == 0; });
+        }
+
+        std::function<void(std::size_t, std::size_t)> body;
+        std::vector<Share> shares;
+        std::atomic<std::size_t> nextSlot{1};
+        std::atomic<std::size_t> remaining;
+        std::mutex doneMutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+
+    static std::size_t defaultConcurrency() {
+#ifdef _OPENMP
+        return static_cast<std::size_t>(std::max(1, omp_get_max_threads()));
+#else
+        return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+#endif
+    }
+
+    // Each queued entry is one helper ticket; a worker that takes it joins the
+    // job with the next free slot. Tickets left after a job drains find no
+    // tasks and return at once.
+    void workerLoop() {
+        for (;;) {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock lock(mutex_);
+                wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+                if (queue_.empty()) {
+                    return;
+                }
+                job = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            job->run(job->nextSlot.fetch_add(1, std::memory_order_relaxed));
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::deque<std::shared_ptr<Job>> queue_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+};
@@ -1,7 +1,9 @@
 #include "monte_carlo_engine.hpp"
+#include "simd_dispatch.hpp"
 
 #include <algorithm>
 #include <cctype>
+#include <cmath>
 #include <exception>
 #include <iomanip>
 #include <iostream>
@@ -12,10 +14,6 @@
 #include <utility>
 #include <vector>
 
-#ifdef _OPENMP
-#include <omp.h>
-#endif
-
 namespace {
 
 using ArgMap = std::unordered_map<std::string, std::string>;
@@ -29,28 +27,69 @@ void printUsage(const char* exe) {
               << "Commands:\n"
               << "  option       Price a European option via Monte Carlo\n"
               << "  var          Estimate portfolio VaR and Expected Shortfall\n"
-              << "  convergence  Run a convergence study against Black-Scholes\n\n"
+              << "  convergence  Run a convergence study against the analytic price\n\n"
               << "Common Options:\n"
               << "  --spot <value>          Spot price (default: 100)\n"
               << "  --rate <value>          Risk-free rate (default: 0.02)\n"
               << "  --dividend <value>      Dividend yield (default: 0.01)\n"
               << "  --vol <value>           Volatility (default: 0.2)\n"
+              << "  --model <name>          gbm|heston|merton single-asset dynamics (default: gbm)\n"
+              << "  --v0 <value>            Heston initial variance (default: 0.04)\n"
+              << "  --kappa <value>         Heston mean-reversion speed (default: 1.5)\n"
+              << "  --theta <value>         Heston long-run variance (default: 0.04)\n"
+              << "  --xi <value>            Heston volatility of variance (default: 0.5)\n"
+              << "  --rho <value>           Heston spot/variance correlation (default: -0.7)\n"
+              << "  --lambda <value>        Merton jump intensity per year (default: 0.5)\n"
+              << "  --jump-mean <value>     Merton mean log jump (default: -0.1)\n"
+              << "  --jump-vol <value>      Merton log-jump volatility (default: 0.15)\n"
               << "  --maturity <value>      Time to maturity in years (default: 1)\n"
               << "  --steps <value>         Time steps per path (default: 252)\n"
               << "  --paths <value>         Monte Carlo paths (default: 200000)\n"
               << "  --seed <value>          RNG seed (default: 42)\n"
               << "  --antithetic <bool>     Enable antithetic variates (default: true)\n"
               << "  --control <bool>        Enable control variate (default: true)\n"
-              << "  --block <value>         Simulation block size (default: 4096)\n\n"
+              << "  --block <value>         Simulation block size (default: 4096)\n"
+              << "  --threads <value>       Thread budget on the task pool (default: 0 = all)\n"
+              << "  --sampling <mode>       auto|terminal|stepped path sampling (default: auto)\n"
+              << "  --precision <mode>      double|single GBM path kernel (default: double)\n"
+              << "  --sequence <mc|sobol|stratified>\n"
+              << "                          Pseudo-random, scrambled Sobol or stratified paths (default: mc)\n"
+              << "  --replicas <value>      Randomised QMC replicas for Sobol (default: 16)\n"
+              << "  --strata <value>        Terminal-shock strata per stratified group (default: 256)\n"
+              << "  --lhs <bool>            Latin hypercube over the other bridge normals (default: false)\n"
+              << "  --target-se <value>     Stop once the standard error is below this (--paths caps)\n"
+              << "  --target-rel <value>    Stop once the standard error / |estimate| is below this\n"
+              << "  --deadline <seconds>    Wall-clock budget for adaptive rounds\n"
+              << "  --batch <value>         First adaptive round in paths (default: 16384)\n\n"
               << "Option Command Options:\n"
               << "  --strike <value>        Strike price (default: 100)\n"
-              << "  --type <call|put>       Option type (default: call)\n\n"
+              << "  --type <call|put>       Option type (default: call)\n"
+              << "  --strikes <list>        Comma-separated strikes priced on one set of paths\n"
+              << "  --greeks <bool>         Estimate delta, gamma, vega and rho in the same pass\n"
+              << "  --payoff <style>        european|asian|geometric-asian|barrier|lookback\n"
+              << "                          (path-dependent styles monitor every time step)\n"
+              << "  --barrier <value>       Barrier level for --payoff barrier\n"
+              << "  --barrier-type <type>   up-out|up-in|down-out|down-in (default: up-out)\n"
+              << "  --american <bool>       Least-squares Monte Carlo American price (default: false)\n"
+              << "  --basis <value>         LSM polynomial degree in S/K (default: 3)\n"
+              << "  --pilot <value>         LSM pilot paths for the exercise rule (default: 32768);\n"
+              << "                          0 prices in-sample on stored paths (capped at 256 MiB)\n\n"
               << "VaR Command Options:\n"
               << "  --notional <value>      Portfolio notional (default: 1)\n"
-              << "  --percentile <value>    VaR percentile in (0,1) (default: 0.99)\n\n"
+              << "  --percentile <value>    VaR percentile in (0,1) (default: 0.99)\n"
+              << "  --streaming <bool>      Histogram estimator without storing losses (default: false)\n"
+              << "  --tolerance <value>     Streaming VaR error bound / notional (default: 1e-4)\n"
+              << "  --importance <bool>     Mean-shift importance sampling for tail VaR (default: false)\n"
+              << "  --shift <value>         Importance shift in std devs (default: normal quantile)\n"
+              << "  --spots <list>          Comma-separated basket spots (enables portfolio VaR)\n"
+              << "  --vols <list>           Basket volatilities, one per spot\n"
+              << "  --dividends <list>      Basket dividend yields (default: --dividend for all)\n"
+              << "  --weights <list>        Notional shares per asset (default: equal)\n"
+              << "  --correlation <list>    Row-major N x N correlation matrix (default: identity)\n\n"
               << "Convergence Command Options:\n"
               << "  --samples <list>        Comma-separated path counts\n"
-              << "                          (default: 5000,20000,80000,160000)\n";
+              << "                          (default: 5000,20000,80000,160000)\n"
+              << "  --sequence both         Run the study for plain MC and Sobol side by side\n";
 }
 
 ArgMap parseArgs(int argc, char** argv, int startIndex) {
@@ -142,12 +181,20 @@ std::vector<std::size_t> parseSampleList(const ArgMap& args,
     return values;
 }
 
-int detectThreads() {
-#ifdef _OPENMP
-    return omp_get_max_threads();
-#else
-    return 1;
-#endif
+std::vector<double> parseDoubleList(const ArgMap& args, const std::string& name) {
+    const auto it = args.find(name);
+    if (it == args.end()) {
+        return {};
+    }
+    std::vector<double> values;
+    std::stringstream ss(it->second);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            values.push_back(std::stod(item));
+        }
+    }
+    return values;
 }
 
 OutputFormat parseFormat(const ArgMap& args) {
@@ -163,20 +210,79 @@ OutputFormat parseFormat(const ArgMap& args) {
     return OutputFormat::Text;
 }
 
-void printOptionResult(const OptionResult& res, OutputFormat format, int threadCount) {
+const char* sequenceName(RandomSequence sequence) {
+    switch (sequence) {
+        case RandomSequence::Sobol:
+            return "sobol";
+        case RandomSequence::Stratified:
+            return "stratified";
+        default:
+            return "mc";
+    }
+}
+
+// Doubles in JSON output; a missing analytic reference (NaN) becomes null.
+struct JsonNumber {
+    double value;
+};
+
+std::ostream& operator<<(std::ostream& os, JsonNumber number) {
+    if (std::isfinite(number.value)) {
+        return os << number.value;
+    }
+    return os << "null";
+}
+
+// Label for OptionResult.analyticPrice under the chosen dynamics and payoff.
+const char* referenceName(const MarketParams& market, const OptionConfig& option) {
+    if (option.style != PayoffStyle::European) {
+        return "Closed form";
+    }
+    switch (market.model) {
+        case AssetModel::Heston:
+            return "Heston (CF)";
+        case AssetModel::Merton:
+            return "Merton series";
+        case AssetModel::Gbm:
+            break;
+    }
+    return "Black-Scholes";
+}
+
+void printOptionResult(const OptionResult& res,
+                       const char* reference,
+                       OutputFormat format,
+                       int threadCount) {
     if (format == OutputFormat::Json) {
         std::ostringstream oss;
         oss << std::fixed << std::setprecision(10);
         oss << "{\n"
             << "  \"command\": \"option\",\n"
             << "  \"threads\": " << threadCount << ",\n"
+            << "  \"simd\": \"" << simdLevelName(detectSimdLevel()) << "\",\n"
             << "  \"result\": {\n"
             << "    \"price\": " << res.price << ",\n"
             << "    \"standardError\": " << res.standardError << ",\n"
-            << "    \"analyticPrice\": " << res.analyticPrice << ",\n"
-            << "    \"relativeError\": " << res.relativeError << ",\n"
+            << "    \"analyticPrice\": " << JsonNumber{res.analyticPrice} << ",\n"
+            << "    \"relativeError\": " << JsonNumber{res.relativeError} << ",\n"
             << "    \"controlVariateWeight\": " << res.controlVariateWeight << ",\n"
-            << "    \"scenarios\": " << res.scenarios << "\n"
+            << "    \"scenarios\": " << res.scenarios << ",\n"
+            << "    \"threadsUsed\": " << res.threads;
+        if (res.greeks) {
+            const auto greek = [&](const char* name, const GreekEstimate& estimate, bool last) {
+                oss << "      \"" << name << "\": {\"value\": " << estimate.value
+                    << ", \"standardError\": " << estimate.standardError << "}" << (last ? "" : ",")
+                    << "\n";
+            };
+            oss << ",\n"
+                << "    \"greeks\": {\n";
+            greek("delta", res.greeks->delta, false);
+            greek("gamma", res.greeks->gamma, false);
+            greek("vega", res.greeks->vega, false);
+            greek("rho", res.greeks->rho, true);
+            oss << "    }";
+        }
+        oss << "\n"
             << "  }\n"
             << "}\n";
         std::cout << oss.str();
@@ -185,10 +291,22 @@ void printOptionResult(const OptionResult& res, OutputFormat format, int threadC
 
     std::cout << std::fixed << std::setprecision(6);
     std::cout << "Monte Carlo price : " << res.price << " (std. error " << res.standardError << ")\n";
-    std::cout << "Black-Scholes     : " << res.analyticPrice
-              << " (relative error " << res.relativeError * 100.0 << "%)\n";
+    if (!std::isnan(res.analyticPrice)) {
+        std::cout << std::left << std::setw(18) << reference << std::right << ": " << res.analyticPrice
+                  << " (relative error " << res.relativeError * 100.0 << "%)\n";
+    }
     std::cout << "Control variate β : " << res.controlVariateWeight << "\n";
     std::cout << "Paths simulated   : " << res.scenarios << "\n";
+    std::cout << "Threads used      : " << res.threads << "\n";
+    if (res.greeks) {
+        const auto greek = [](const char* label, const GreekEstimate& estimate) {
+            std::cout << label << estimate.value << " (std. error " << estimate.standardError << ")\n";
+        };
+        greek("Delta             : ", res.greeks->delta);
+        greek("Gamma             : ", res.greeks->gamma);
+        greek("Vega              : ", res.greeks->vega);
+        greek("Rho               : ", res.greeks->rho);
+    }
 }
 
 void printVaRResult(const VaRResult& res, OutputFormat format, int threadCount) {
@@ -198,13 +316,18 @@ void printVaRResult(const VaRResult& res, OutputFormat format, int threadCount)
         oss << "{\n"
             << "  \"command\": \"var\",\n"
             << "  \"threads\": " << threadCount << ",\n"
+            << "  \"simd\": \"" << simdLevelName(detectSimdLevel()) << "\",\n"
             << "  \"result\": {\n"
             << "    \"percentile\": " << res.percentile << ",\n"
             << "    \"valueAtRisk\": " << res.valueAtRisk << ",\n"
             << "    \"expectedShortfall\": " << res.expectedShortfall << ",\n"
             << "    \"meanLoss\": " << res.meanLoss << ",\n"
             << "    \"lossStdDev\": " << res.lossStdDev << ",\n"
-            << "    \"scenarios\": " << res.scenarios << "\n"
+            << "    \"scenarios\": " << res.scenarios << ",\n"
+            << "    \"errorBound\": " << res.errorBound << ",\n"
+            << "    \"standardError\": " << res.standardError << ",\n"
+            << "    \"effectiveSampleSize\": " << res.effectiveSampleSize << ",\n"
+            << "    \"threadsUsed\": " << res.threads << "\n"
             << "  }\n"
             << "}\n";
         std::cout << oss.str();
@@ -213,9 +336,81 @@ void printVaRResult(const VaRResult& res, OutputFormat format, int threadCount)
 
     std::cout << std::fixed << std::setprecision(6);
     std::cout << "Value-at-Risk (" << res.percentile * 100.0 << "%) : " << res.valueAtRisk << "\n";
+    std::cout << "VaR standard error               : " << res.standardError << "\n";
     std::cout << "Expected Shortfall               : " << res.expectedShortfall << "\n";
     std::cout << "Mean loss / Std Dev              : " << res.meanLoss << " / " << res.lossStdDev << "\n";
     std::cout << "Scenarios                         : " << res.scenarios << "\n";
+    std::cout << "Threads used                      : " << res.threads << "\n";
+    if (res.effectiveSampleSize != static_cast<double>(res.scenarios)) {
+        std::cout << "Tail effective sample size        : " << res.effectiveSampleSize << "\n";
+    }
+    if (res.errorBound > 0.0) {
+        std::cout << "VaR error bound                   : " << res.errorBound << "\n";
+    }
+}
+
+void printOptionChain(const std::vector<OptionConfig>& options,
+                      const std::vector<OptionResult>& results,
+                      const char* reference,
+                      OutputFormat format,
+                      int threadCount) {
+    if (format == OutputFormat::Json) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(10);
+        oss << "{\n"
+            << "  \"command\": \"option\",\n"
+            << "  \"threads\": " << threadCount << ",\n"
+            << "  \"simd\": \"" << simdLevelName(detectSimdLevel()) << "\",\n"
+            << "  \"result\": [\n";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const auto& res = results[i];
+            oss << "    {\n"
+                << "      \"strike\": " << options[i].strike << ",\n"
+                << "      \"price\": " << res.price << ",\n"
+                << "      \"standardError\": " << res.standardError << ",\n"
+                << "      \"analyticPrice\": " << JsonNumber{res.analyticPrice} << ",\n"
+                << "      \"relativeError\": " << JsonNumber{res.relativeError} << ",\n"
+                << "      \"controlVariateWeight\": " << res.controlVariateWeight << ",\n"
+                << "      \"scenarios\": " << res.scenarios << ",\n"
+                << "      \"threadsUsed\": " << res.threads << "\n"
+                << "    }";
+            if (i + 1 < results.size()) {
+                oss << ",";
+            }
+            oss << "\n";
+        }
+        oss << "  ]\n"
+            << "}\n";
+        std::cout << oss.str();
+        return;
+    }
+
+    // Chains without a reference price (American) drop its columns.
+    const bool hasReference = std::any_of(results.begin(), results.end(),
+                                          [](const OptionResult& res) { return !std::isnan(res.analyticPrice); });
+    std::cout << std::fixed << std::setprecision(6);
+    std::cout << std::setw(12) << "Strike"
+              << std::setw(18) << "Price"
+              << std::setw(18) << "Std Error";
+    if (hasReference) {
+        std::cout << std::setw(18) << reference
+                  << std::setw(18) << "Rel Error";
+    }
+    std::cout << "\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        std::cout << std::setw(12) << options[i].strike
+                  << std::setw(18) << results[i].price
+                  << std::setw(18) << results[i].standardError;
+        if (hasReference) {
+            std::cout << std::setw(18) << results[i].analyticPrice
+                      << std::setw(18) << results[i].relativeError;
+        }
+        std::cout << "\n";
+    }
+    if (!results.empty()) {
+        std::cout << "Paths simulated   : " << results.front().scenarios << "\n";
+        std::cout << "Threads used      : " << results.front().threads << "\n";
+    }
 }
 
 void printConvergence(const std::vector<ConvergencePoint>& points,
@@ -227,15 +422,23 @@ void printConvergence(const std::vector<ConvergencePoint>& points,
         oss << "{\n"
             << "  \"command\": \"convergence\",\n"
             << "  \"threads\": " << threadCount << ",\n"
+            << "  \"simd\": \"" << simdLevelName(detectSimdLevel()) << "\",\n"
             << "  \"result\": [\n";
         for (std::size_t i = 0; i < points.size(); ++i) {
             const auto& point = points[i];
             oss << "    {\n"
+                << "      \"sequence\": \"" << sequenceName(point.sequence) << "\",\n"
                 << "      \"scenarios\": " << point.scenarios << ",\n"
                 << "      \"price\": " << point.price << ",\n"
                 << "      \"absoluteError\": " << point.absoluteError << ",\n"
                 << "      \"relativeError\": " << point.relativeError << ",\n"
-                << "      \"standardError\": " << point.standardError << "\n"
+                << "      \"standardError\": " << point.standardError;
+            if (point.doublePrice) {
+                oss << ",\n"
+                    << "      \"doublePrice\": " << *point.doublePrice << ",\n"
+                    << "      \"precisionBound\": " << point.precisionBound;
+            }
+            oss << "\n"
                 << "    }";
             if (i + 1 < points.size()) {
                 oss << ",";
@@ -253,19 +456,31 @@ void printConvergence(const std::vector<ConvergencePoint>& points,
         return;
     }
     std::cout << std::fixed << std::setprecision(6);
-    std::cout << std::setw(12) << "Paths"
+    std::cout << std::setw(10) << "Sequence"
+              << std::setw(12) << "Paths"
               << std::setw(18) << "Price"
               << std::setw(18) << "Abs Error"
               << std::setw(18) << "Rel Error"
-              << std::setw(18) << "Std Error"
-              << "\n";
+              << std::setw(18) << "Std Error";
+    const bool crossCheck = points.front().doublePrice.has_value();
+    if (crossCheck) {
+        std::cout << std::setw(18) << "Double Gap" << std::setw(18) << "Gap Bound";
+    }
+    std::cout << "\n";
     for (const auto& point : points) {
-        std::cout << std::setw(12) << point.scenarios
+        std::cout << std::setw(10) << sequenceName(point.sequence)
+                  << std::setw(12) << point.scenarios
                   << std::setw(18) << point.price
                   << std::setw(18) << point.absoluteError
                   << std::setw(18) << point.relativeError
-                  << std::setw(18) << point.standardError
-                  << "\n";
+                  << std::setw(18) << point.standardError;
+        if (crossCheck) {
+            std::cout << std::scientific << std::setprecision(3)
+                      << std::setw(18) << point.price - point.doublePrice.value_or(point.price)
+                      << std::setw(18) << point.precisionBound
+                      << std::fixed << std::setprecision(6);
+        }
+        std::cout << "\n";
     }
 }
 
@@ -275,9 +490,102 @@ MarketParams buildMarket(const ArgMap& args) {
     market.riskFreeRate = getDouble(args, "rate", 0.02);
     market.dividendYield = getDouble(args, "dividend", 0.01);
     market.volatility = getDouble(args, "vol", 0.2);
+
+    std::string model = getString(args, "model", "gbm");
+    std::transform(model.begin(), model.end(), model.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (model == "heston") {
+        market.model = AssetModel::Heston;
+        market.heston.initialVariance = getDouble(args, "v0", market.heston.initialVariance);
+        market.heston.meanReversion = getDouble(args, "kappa", market.heston.meanReversion);
+        market.heston.longRunVariance = getDouble(args, "theta", market.heston.longRunVariance);
+        market.heston.volOfVol = getDouble(args, "xi", market.heston.volOfVol);
+        market.heston.correlation = getDouble(args, "rho", market.heston.correlation);
+    } else if (model == "merton") {
+        market.model = AssetModel::Merton;
+        market.merton.jumpIntensity = getDouble(args, "lambda", market.merton.jumpIntensity);
+        market.merton.jumpMean = getDouble(args, "jump-mean", market.merton.jumpMean);
+        market.merton.jumpVolatility = getDouble(args, "jump-vol", market.merton.jumpVolatility);
+    } else if (model != "gbm") {
+        throw std::invalid_argument("Unknown model: " + model);
+    }
+
+    const std::vector<double> spots = parseDoubleList(args, "spots");
+    if (spots.empty()) {
+        return market;
+    }
+    const std::vector<double> vols = parseDoubleList(args, "vols");
+    const std::vector<double> dividends = parseDoubleList(args, "dividends");
+    const std::vector<double> weights = parseDoubleList(args, "weights");
+    if (vols.size() != spots.size()) {
+        throw std::invalid_argument("--vols must list one volatility per basket spot");
+    }
+    if (!dividends.empty() && dividends.size() != spots.size()) {
+        throw std::invalid_argument("--dividends must list one yield per basket spot");
+    }
+    if (!weights.empty() && weights.size() != spots.size()) {
+        throw std::invalid_argument("--weights must list one weight per basket spot");
+    }
+    for (std::size_t i = 0; i < spots.size(); ++i) {
+        AssetParams asset;
+        asset.spot = spots[i];
+        asset.volatility = vols[i];
+        asset.dividendYield = dividends.empty() ? market.dividendYield : dividends[i];
+        asset.weight = weights.empty() ? 1.0 / static_cast<double>(spots.size()) : weights[i];
+        market.basket.push_back(asset);
+    }
+    market.correlation = parseDoubleList(args, "correlation");
     return market;
 }
 
+PathSampling parseSampling(const ArgMap& args) {
+    std::string mode = getString(args, "sampling", "auto");
+    std::transform(mode.begin(), mode.end(), mode.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (mode == "auto") {
+        return PathSampling::Auto;
+    }
+    if (mode == "terminal") {
+        return PathSampling::Terminal;
+    }
+    if (mode == "stepped") {
+        return PathSampling::Stepped;
+    }
+    throw std::invalid_argument("Unknown sampling mode: " + mode);
+}
+
+PathPrecision parsePrecision(const ArgMap& args) {
+    std::string mode = getString(args, "precision", "double");
+    std::transform(mode.begin(), mode.end(), mode.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (mode == "double") {
+        return PathPrecision::Double;
+    }
+    if (mode == "single") {
+        return PathPrecision::Single;
+    }
+    throw std::invalid_argument("Unknown precision: " + mode);
+}
+
+std::vector<RandomSequence> parseSequences(const ArgMap& args, bool allowBoth) {
+    std::string name = getString(args, "sequence", "mc");
+    std::transform(name.begin(), name.end(), name.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (name == "mc") {
+        return {RandomSequence::PseudoRandom};
+    }
+    if (name == "sobol") {
+        return {RandomSequence::Sobol};
+    }
+    if (name == "stratified") {
+        return {RandomSequence::Stratified};
+    }
+    if (name == "both" && allowBoth) {
+        return {RandomSequence::PseudoRandom, RandomSequence::Sobol};
+    }
+    throw std::invalid_argument("Unknown sequence: " + name);
+}
+
 SimulationConfig buildSimulation(const ArgMap& args) {
     SimulationConfig sim;
     sim.maturity = getDouble(args, "maturity", 1.0);
@@ -288,6 +596,16 @@ SimulationConfig buildSimulation(const ArgMap& args) {
     sim.useControlVariate = getBool(args, "control", true);
     sim.blockSize = getSizeT(args, "block", 4096);
     sim.varConfidenceLevel = getDouble(args, "percentile", 0.99);
+    sim.sampling = parseSampling(args);
+    sim.precision = parsePrecision(args);
+    sim.qmcReplicas = getSizeT(args, "replicas", sim.qmcReplicas);
+    sim.strata = getSizeT(args, "strata", sim.strata);
+    sim.latinHypercube = getBool(args, "lhs", false);
+    sim.targetStandardError = getDouble(args, "target-se", 0.0);
+    sim.targetRelativeError = getDouble(args, "target-rel", 0.0);
+    sim.deadlineSeconds = getDouble(args, "deadline", 0.0);
+    sim.adaptiveBatch = getSizeT(args, "batch", sim.adaptiveBatch);
+    sim.threads = getSizeT(args, "threads", 0);
     return sim;
 }
 
@@ -304,6 +622,40 @@ OptionConfig buildOption(const ArgMap& args, double defaultStrike) {
     } else {
         throw std::invalid_argument("Unknown option type: " + type);
     }
+    cfg.computeGreeks = getBool(args, "greeks", false);
+
+    std::string payoff = getString(args, "payoff", "european");
+    std::transform(payoff.begin(), payoff.end(), payoff.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (payoff == "european") {
+        cfg.style = PayoffStyle::European;
+    } else if (payoff == "asian") {
+        cfg.style = PayoffStyle::ArithmeticAsian;
+    } else if (payoff == "geometric-asian") {
+        cfg.style = PayoffStyle::GeometricAsian;
+    } else if (payoff == "barrier") {
+        cfg.style = PayoffStyle::Barrier;
+    } else if (payoff == "lookback") {
+        cfg.style = PayoffStyle::Lookback;
+    } else {
+        throw std::invalid_argument("Unknown payoff: " + payoff);
+    }
+
+    cfg.barrier = getDouble(args, "barrier", 0.0);
+    std::string barrierType = getString(args, "barrier-type", "up-out");
+    std::transform(barrierType.begin(), barrierType.end(), barrierType.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (barrierType == "up-out") {
+        cfg.barrierType = BarrierType::UpAndOut;
+    } else if (barrierType == "up-in") {
+        cfg.barrierType = BarrierType::UpAndIn;
+    } else if (barrierType == "down-out") {
+        cfg.barrierType = BarrierType::DownAndOut;
+    } else if (barrierType == "down-in") {
+        cfg.barrierType = BarrierType::DownAndIn;
+    } else {
+        throw std::invalid_argument("Unknown barrier type: " + barrierType);
+    }
     return cfg;
 }
 
@@ -326,6 +678,8 @@ int main(int argc, char** argv) {
         return 1;
     }
 
+    MonteCarloEngine::calibrateThreading();
+
     OutputFormat format = OutputFormat::Text;
     bool formatParsed = false;
 
@@ -334,32 +688,72 @@ int main(int argc, char** argv) {
         SimulationConfig sim = buildSimulation(args);
         format = parseFormat(args);
         formatParsed = true;
-        const int threads = detectThreads();
+
+        const std::vector<RandomSequence> sequences = parseSequences(args, command == "convergence");
+        sim.sequence = sequences.front();
+        MonteCarloEngine engine(market, sim);
+        const auto threads = static_cast<int>(engine.threadCount());
 
         if (format == OutputFormat::Text) {
             std::cout << "High-Performance Risk Simulation Engine\n"
-                      << "OpenMP threads: " << threads << "\n\n";
+                      << "Threads: " << threads << "\n"
+                      << "SIMD: " << simdLevelName(detectSimdLevel()) << "\n\n";
         }
 
-        MonteCarloEngine engine(market, sim);
-
         if (command == "option") {
             const OptionConfig option = buildOption(args, market.spot);
-            const OptionResult res = engine.priceEuropeanOption(option);
-            printOptionResult(res, format, threads);
+            const std::vector<double> strikes = parseDoubleList(args, "strikes");
+            if (getBool(args, "american", false)) {
+                AmericanConfig american;
+                american.basisDegree = getSizeT(args, "basis", american.basisDegree);
+                american.pilotPaths = getSizeT(args, "pilot", american.pilotPaths);
+                if (strikes.empty()) {
+                    printOptionResult(engine.priceAmericanOption(option, american), "American (LSM)", format,
+                                      threads);
+                } else {
+                    std::vector<OptionConfig> chain(strikes.size(), option);
+                    std::vector<OptionResult> results;
+                    for (std::size_t i = 0; i < strikes.size(); ++i) {
+                        chain[i].strike = strikes[i];
+                        results.push_back(engine.priceAmericanOption(chain[i], american));
+                    }
+                    printOptionChain(chain, results, "American (LSM)", format, threads);
+                }
+            } else if (strikes.empty()) {
+                const OptionResult res = engine.priceEuropeanOption(option);
+                printOptionResult(res, referenceName(market, option), format, threads);
+            } else {
+                std::vector<OptionConfig> chain(strikes.size(), option);
+                for (std::size_t i = 0; i < strikes.size(); ++i) {
+                    chain[i].strike = strikes[i];
+                }
+                printOptionChain(chain, engine.priceEuropeanOptions(chain), referenceName(market, option),
+                                 format, threads);
+            }
         } else if (command == "var") {
             VaRConfig varCfg;
             varCfg.percentile = getDouble(args, "percentile", sim.varConfidenceLevel);
             varCfg.notional = getDouble(args, "notional", 1.0);
+            varCfg.streaming = getBool(args, "streaming", false);
+            varCfg.streamingTolerance = getDouble(args, "tolerance", varCfg.streamingTolerance);
+            varCfg.importanceSampling = getBool(args, "importance", false);
+            varCfg.importanceShift = getDouble(args, "shift", 0.0);
             const VaRResult res = engine.computeParametricVaR(varCfg);
             printVaRResult(res, format, threads);
         } else if (command == "convergence") {
             const OptionConfig option = buildOption(args, market.spot);
             const std::vector<std::size_t> defaults{5000, 20000, 80000, 160000};
             const std::vector<std::size_t> samples = parseSampleList(args, "samples", defaults);
-            const std::vector<ConvergencePoint> points = engine.convergenceStudy(option, samples);
+            std::vector<ConvergencePoint> points;
+            for (RandomSequence sequence : sequences) {
+                SimulationConfig studySim = sim;
+                studySim.sequence = sequence;
+                const std::vector<ConvergencePoint> study =
+                    MonteCarloEngine(market, studySim).convergenceStudy(option, samples);
+                points.insert(points.end(), study.begin(), study.end());
+            }
             if (format == OutputFormat::Text) {
-                std::cout << "Convergence study vs. Black-Scholes analytic price\n";
+                std::cout << "Convergence study vs. " << referenceName(market, option) << " analytic price\n";
             }
             printConvergence(points, format, threads);
         } else {
@@ -0,0 +1,36 @@
+#include "path_kernels.hpp"
+
+#include "path_kernels_impl.hpp"
+
+namespace path_kernels_detail {
+
+const PathKernels& baselineKernels() noexcept {
+    static constexpr PathKernels kernels = kernelTable(SimdLevel::Baseline);
+    return kernels;
+}
+
+}  // namespace path_kernels_detail
+
+const PathKernels& pathKernels() noexcept {
+    using namespace path_kernels_detail;
+    // Same priority as the clone resolver; SSE4.2 adds nothing Eigen uses here.
+    static const PathKernels& selected = []() -> const PathKernels& {
+        switch (detectSimdLevel()) {
+            case SimdLevel::Avx512:
+                if (const PathKernels* kernels = avx512Kernels()) {
+                    return *kernels;
+                }
+                [[fallthrough]];
+            case SimdLevel::Avx2:
+                if (const PathKernels* kernels = avx2Kernels()) {
+                    return *kernels;
+                }
+                [[fallthrough]];
+            case SimdLevel::Sse42:
+            case SimdLevel::Baseline:
+                break;
+        }
+        return baselineKernels();
+    }();
+    return selected;
+}
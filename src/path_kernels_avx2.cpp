@@ -0,0 +1,20 @@
+// Path kernels at x86-64-v3. Compile this unit with -mavx2 -mfma so Eigen runs
+// four-lane double and eight-lane float packets; without them it reports no table.
+#include "path_kernels.hpp"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include "path_kernels_impl.hpp"
+#endif
+
+namespace path_kernels_detail {
+
+const PathKernels* avx2Kernels() noexcept {
+#if defined(__AVX2__) && defined(__FMA__)
+    static constexpr PathKernels kernels = kernelTable(SimdLevel::Avx2);
+    return &kernels;
+#else
+    return nullptr;
+#endif
+}
+
+}  // namespace path_kernels_detail
@@ -0,0 +1,22 @@
+// Path kernels at x86-64-v4. Compile this unit with -mavx512f -mfma so Eigen runs
+// eight-lane double and sixteen-lane float packets; without them it reports no table.
+// GCC 12 reports its own AVX-512 intrinsics under -Wuninitialized once they are
+// inlined (PR 105593), so the unit also takes -Wno-uninitialized there.
+#include "path_kernels.hpp"
+
+#if defined(__AVX512F__) && defined(__FMA__)
+#include "path_kernels_impl.hpp"
+#endif
+
+namespace path_kernels_detail {
+
+const PathKernels* avx512Kernels() noexcept {
+#if defined(__AVX512F__) && defined(__FMA__)
+    static constexpr PathKernels kernels = kernelTable(SimdLevel::Avx512);
+    return &kernels;
+#else
+    return nullptr;
+#endif
+}
+
+}  // namespace path_kernels_detail
@@ -0,0 +1,74 @@
+#pragma once
+
+// Kernel bodies shared by the per-ISA translation units; include once per unit,
+// after path_kernels.hpp. Everything here has internal linkage and the kernels are
+// flattened, so no Eigen instance built at a wider ISA is emitted out of line
+// where the linker could hand it to baseline code.
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cstddef>
+
+#include "path_kernels.hpp"
+
+namespace {
+
+using Lanes = Eigen::Array<double, kPathKernelLanes, 1>;
+using FloatLanes = Eigen::Array<float, kPathKernelLanes, 1>;
+
+// Runs batch(x, out) on every full batch of x, then on the zero-padded tail with
+// out's tail staged in a local batch (accumulating kernels read it).
+template <typename In, typename Batch>
+[[gnu::always_inline]] inline void forEachBatch(const In* x, std::size_t n, double* out, Batch&& batch) {
+    using InLanes = Eigen::Array<In, kPathKernelLanes, 1>;
+    std::size_t i = 0;
+    for (; i + kPathKernelLanes <= n; i += kPathKernelLanes) {
+        batch(InLanes(Eigen::Map<const InLanes>(x + i)), Eigen::Map<Lanes>(out + i));
+    }
+    if (i < n) {
+        const std::size_t tail = n - i;
+        InLanes in = InLanes::Zero();
+        std::copy(x + i, x + n, in.data());
+        Lanes result = Lanes::Zero();
+        std::copy(out + i, out + n, result.data());
+        batch(in, Eigen::Map<Lanes>(result.data()));
+        std::copy(result.data(), result.data() + tail, out + i);
+    }
+}
+
+[[gnu::flatten]] void scaledExp(const double* x, std::size_t n, double scale, double offset, double slope,
+                                double* out) {
+    forEachBatch(x, n, out, [&](const Lanes& in, Eigen::Map<Lanes> dst) {
+        dst = scale * (offset + slope * in).exp();
+    });
+}
+
+[[gnu::flatten]] void scaledExpFloat(const float* x, std::size_t n, float scale, float offset, float slope,
+                                     double* out) {
+    forEachBatch(x, n, out, [&](const FloatLanes& in, Eigen::Map<Lanes> dst) {
+        dst = (scale * (offset + slope * in).exp()).cast<double>();
+    });
+}
+
+[[gnu::flatten]] void accumulateReturn(const double* x, std::size_t n, double offset, double weight, double* sum) {
+    forEachBatch(x, n, sum, [&](const Lanes& in, Eigen::Map<Lanes> dst) {
+        dst += weight * ((in + offset).exp() - 1.0);
+    });
+}
+
+[[gnu::flatten]] void discountedIntrinsic(const double* spot, std::size_t n, double strike, bool isCall,
+                                          double discount, double* out) {
+    forEachBatch(spot, n, out, [&](const Lanes& in, Eigen::Map<Lanes> dst) {
+        if (isCall) {
+            dst = discount * (in - strike).max(0.0);
+        } else {
+            dst = discount * (strike - in).max(0.0);
+        }
+    });
+}
+
+constexpr PathKernels kernelTable(SimdLevel level) {
+    return {level, &scaledExp, &scaledExpFloat, &accumulateReturn, &discountedIntrinsic};
+}
+
+}  // namespace
@@ -1,19 +1,17 @@
 #include "monte_carlo_engine.hpp"
+#include "simd_dispatch.hpp"
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <unistd.h>
 
-#ifdef _OPENMP
-#include <omp.h>
-#endif
-
 #include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cctype>
 #include <cerrno>
+#include <cmath>
 #include <cstdlib>
 #include <ctime>
 #include <deque>
@@ -39,6 +37,16 @@ namespace {
 
 using Clock = std::chrono::system_clock;
 
+// Doubles in JSON output; a missing analytic reference (NaN) becomes null.
+struct JsonNumber {
+    double value;
+};
+
+std::ostream& operator<<(std::ostream& os, JsonNumber number) {
+    if (std::isfinite(number.value)) return os << number.value;
+    return os << "null";
+}
+
 std::string trimCopy(std::string_view text) {
     std::size_t begin = 0;
     while (begin < text.size() && std::isspace(static_cast<unsigned char>(text[begin]))) {
@@ -259,6 +267,7 @@ struct SimulationRecord {
     std::string timestamp;
     double durationSeconds = 0.0;
     int threadCount = 1;
+    std::string simdLevel;  // kernel clone the CPU dispatched to
     std::size_t samplesProcessed = 0;  // number of simulated paths
     double throughputPerSec = 0.0;     // paths per second for quick diagnostics
     MarketParams market;
@@ -341,6 +350,9 @@ std::string toJson(const SimulationRecord& rec) {
         << "\"timestamp\":\"" << rec.timestamp << "\"," 
         << "\"durationSeconds\":" << rec.durationSeconds << ","
         << "\"threadCount\":" << rec.threadCount;
+    if (!rec.simdLevel.empty()) {
+        oss << ",\"simdLevel\":\"" << rec.simdLevel << "\"";
+    }
     if (rec.samplesProcessed > 0) {
         oss << ",\"samplesProcessed\":" << rec.samplesProcessed;
     }
@@ -351,8 +363,8 @@ std::string toJson(const SimulationRecord& rec) {
         oss << ",\"result\":{"
             << "\"price\":" << rec.optionResult.price << ","
             << "\"standardError\":" << rec.optionResult.standardError << ","
-            << "\"analyticPrice\":" << rec.optionResult.analyticPrice << ","
-            << "\"relativeError\":" << rec.optionResult.relativeError << ","
+            << "\"analyticPrice\":" << JsonNumber{rec.optionResult.analyticPrice} << ","
+            << "\"relativeError\":" << JsonNumber{rec.optionResult.relativeError} << ","
             << "\"controlVariateWeight\":" << rec.optionResult.controlVariateWeight << "}"
             << ",\"input\":{"
             << "\"spot\":" << rec.market.spot << ","
@@ -411,16 +423,36 @@ std::string toJson(const std::vector<HistoricalPoint>& points) {
     return oss.str();
 }
 
+// Echoed request text inside a JSON string: quotes and backslashes escaped,
+// control characters dropped.
+std::string jsonEscape(std::string_view text) {
+    std::string out;
+    out.reserve(text.size());
+    for (const char c : text) {
+        if (static_cast<unsigned char>(c) < 0x20) continue;
+        if (c == '"' || c == '\\') out.push_back('\\');
+        out.push_back(c);
+    }
+    return out;
+}
+
+// A query value that is a number in full, or nullopt.
+std::optional<double> parseDouble(const std::string& text) {
+    try {
+        std::size_t used = 0;
+        const double value = std::stod(text, &used);
+        if (used == text.size()) return value;
+    } catch (...) {
+    }
+    return std::nullopt;
+}
+
 double getDouble(const std::unordered_map<std::string, std::string>& params,
                  const std::string& key,
                  double fallback) {
     auto it = params.find(key);
     if (it == params.end()) return fallback;
-    try {
-        return std::stod(it->second);
-    } catch (...) {
-        return fallback;
-    }
+    return parseDouble(it->second).value_or(fallback);
 }
 
 std::size_t getSize(const std::unordered_map<std::string, std::string>& params,
@@ -447,6 +479,99 @@ bool getBool(const std::unordered_map<std::string, std::string>& params,
     return fallback;
 }
 
+PathSampling getSampling(const std::unordered_map<std::string, std::string>& params,
+                         const std::string& key,
+                         PathSampling fallback) {
+    auto it = params.find(key);
+    if (it == params.end()) return fallback;
+    std::string value = it->second;
+    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+    if (value == "auto") return PathSampling::Auto;
+    if (value == "terminal") return PathSampling::Terminal;
+    if (value == "stepped") return PathSampling::Stepped;
+    return fallback;
+}
+
+PathPrecision getPrecision(const std::unordered_map<std::string, std::string>& params,
+                           const std::string& key,
+                           PathPrecision fallback) {
+    auto it = params.find(key);
+    if (it == params.end()) return fallback;
+    std::string value = it->second;
+    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+    if (value == "double") return PathPrecision::Double;
+    if (value == "single") return PathPrecision::Single;
+    return fallback;
+}
+
+RandomSequence getSequence(const std::unordered_map<std::string, std::string>& params,
+                           const std::string& key,
+                           RandomSequence fallback) {
+    auto it = params.find(key);
+    if (it == params.end()) return fallback;
+    std::string value = it->second;
+    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+    if (value == "mc") return RandomSequence::PseudoRandom;
+    if (value == "sobol") return RandomSequence::Sobol;
+    if (value == "stratified") return RandomSequence::Stratified;
+    return fallback;
+}
+
+// Optional dynamics: model=heston with v0, kappa, theta, xi, rho, or
+// model=merton with lambda, jumpMean, jumpVol.
+void applyModel(const std::unordered_map<std::string, std::string>& params, MarketParams& market) {
+    auto it = params.find("model");
+    if (it == params.end()) return;
+    std::string value = it->second;
+    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+    if (value == "merton") {
+        market.model = AssetModel::Merton;
+        market.merton.jumpIntensity = getDouble(params, "lambda", market.merton.jumpIntensity);
+        market.merton.jumpMean = getDouble(params, "jumpMean", market.merton.jumpMean);
+        market.merton.jumpVolatility = getDouble(params, "jumpVol", market.merton.jumpVolatility);
+        return;
+    }
+    if (value != "heston") return;
+    market.model = AssetModel::Heston;
+    market.heston.initialVariance = getDouble(params, "v0", market.heston.initialVariance);
+    market.heston.meanReversion = getDouble(params, "kappa", market.heston.meanReversion);
+    market.heston.longRunVariance = getDouble(params, "theta", market.heston.longRunVariance);
+    market.heston.volOfVol = getDouble(params, "xi", market.heston.volOfVol);
+    market.heston.correlation = getDouble(params, "rho", market.heston.correlation);
+}
+
+// Optional path-dependent payoff: payoff=asian|geometric-asian|barrier|lookback,
+// with barrier and barrierType=up-out|up-in|down-out|down-in for barriers.
+void applyPayoff(const std::unordered_map<std::string, std::string>& params, OptionConfig& option) {
+    auto lower = [&](const std::string& key, const std::string& fallback) {
+        auto it = params.find(key);
+        std::string value = it == params.end() ? fallback : it->second;
+        std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+        return value;
+    };
+    const std::string payoff = lower("payoff", "european");
+    if (payoff == "asian") option.style = PayoffStyle::ArithmeticAsian;
+    if (payoff == "geometric-asian") option.style = PayoffStyle::GeometricAsian;
+    if (payoff == "barrier") option.style = PayoffStyle::Barrier;
+    if (payoff == "lookback") option.style = PayoffStyle::Lookback;
+
+    option.barrier = getDouble(params, "barrier", option.barrier);
+    const std::string barrierType = lower("barrierType", "up-out");
+    if (barrierType == "up-in") option.barrierType = BarrierType::UpAndIn;
+    if (barrierType == "down-out") option.barrierType = BarrierType::DownAndOut;
+    if (barrierType == "down-in") option.barrierType = BarrierType::DownAndIn;
+}
+
+// Optional adaptive path count: targetSE and/or targetRel stop once the standard
+// error is small enough, deadline bounds the wall-clock seconds; paths is the cap
+// and batch the first round.
+void applyAdaptive(const std::unordered_map<std::string, std::string>& params, SimulationConfig& sim) {
+    sim.targetStandardError = getDouble(params, "targetSE", 0.0);
+    sim.targetRelativeError = getDouble(params, "targetRel", 0.0);
+    sim.deadlineSeconds = getDouble(params, "deadline", 0.0);
+    sim.adaptiveBatch = getSize(params, "batch", sim.adaptiveBatch);
+}
+
 struct ServerConfig {
     int port = 8080;
     std::size_t maxRecords = 128;
@@ -539,7 +664,8 @@ public:
     }
 
     void run() {
-        std::cout << "[risk_dashboard] listening on port " << config_.port << std::endl;
+        std::cout << "[risk_dashboard] listening on port " << config_.port
+                  << " simd=" << simdLevelName(detectSimdLevel()) << std::endl;
         running_.store(true);
         while (running_.load()) {
             sockaddr_in clientAddr{};
@@ -715,6 +841,7 @@ private:
         market.riskFreeRate = getDouble(params, "rate", 0.02);
         market.dividendYield = getDouble(params, "dividend", 0.01);
         market.volatility = getDouble(params, "vol", 0.2);
+        applyModel(params, market);
 
         SimulationConfig sim;
         sim.maturity = getDouble(params, "maturity", 1.0);
@@ -724,6 +851,14 @@ private:
         sim.useAntithetic = getBool(params, "antithetic", true);
         sim.useControlVariate = getBool(params, "control", true);
         sim.blockSize = getSize(params, "block", 4096);
+        sim.threads = getSize(params, "threads", 0);
+        sim.sampling = getSampling(params, "sampling", PathSampling::Auto);
+        sim.precision = getPrecision(params, "precision", PathPrecision::Double);
+        sim.sequence = getSequence(params, "sequence", RandomSequence::PseudoRandom);
+        sim.qmcReplicas = getSize(params, "replicas", sim.qmcReplicas);
+        sim.strata = getSize(params, "strata", sim.strata);
+        sim.latinHypercube = getBool(params, "lhs", false);
+        applyAdaptive(params, sim);
 
         OptionConfig opt;
         opt.strike = getDouble(params, "strike", market.spot);
@@ -732,26 +867,66 @@ private:
             return it == params.end() ? std::string("call") : it->second;
         }();
         opt.isCall = (type != "put");
+        opt.computeGreeks = getBool(params, "greeks", false);
+        applyPayoff(params, opt);
+
+        // Optional strike chain priced on the same paths; the ledger records the
+        // first strike.
+        std::vector<OptionConfig> chain;
+        if (auto it = params.find("strikes"); it != params.end()) {
+            std::stringstream ss(it->second);
+            std::string item;
+            while (std::getline(ss, item, ',')) {
+                if (!item.empty()) {
+                    const std::optional<double> strike = parseDouble(item);
+                    if (!strike) {
+                        const std::string body = "{\"error\":\"Invalid strike '" + jsonEscape(item) + "' in strikes\"}";
+                        const std::string resp = httpResponse(body, "application/json", 400, "Bad Request");
+                        ::send(clientFd, resp.data(), resp.size(), 0);
+                        return;
+                    }
+                    OptionConfig entry = opt;
+                    entry.strike = *strike;
+                    chain.push_back(entry);
+                }
+            }
+        }
+        if (chain.empty()) {
+            chain.push_back(opt);
+        }
+        opt = chain.front();
 
         const auto start = Clock::now();
         MonteCarloEngine engine(market, sim);
-        const OptionResult result = engine.priceEuropeanOption(opt);
+        // american=true prices each strike by least-squares Monte Carlo.
+        std::vector<OptionResult> results;
+        std::size_t basePaths = 0;
+        if (getBool(params, "american", false)) {
+            AmericanConfig american;
+            american.basisDegree = getSize(params, "basis", american.basisDegree);
+            american.pilotPaths = getSize(params, "pilot", american.pilotPaths);
+            for (const OptionConfig& entry : chain) {
+                results.push_back(engine.priceAmericanOption(entry, american));
+                basePaths += results.back().basePaths;
+            }
+        } else {
+            // One pass over shared paths prices the whole chain.
+            results = engine.priceEuropeanOptions(chain);
+            basePaths = results.front().basePaths;
+        }
+        const OptionResult& result = results.front();
         const auto duration = std::chrono::duration<double>(Clock::now() - start).count();
 
         SimulationRecord record;
         record.command = "option";
         record.timestamp = isoTimestamp(Clock::now());
         record.durationSeconds = duration;
-        record.threadCount =
-#ifdef _OPENMP
-            omp_get_max_threads();
-#else
-            1;
-#endif
-        record.samplesProcessed = sim.paths;
+        record.threadCount = static_cast<int>(result.threads);
+        record.simdLevel = simdLevelName(detectSimdLevel());
+        record.samplesProcessed = basePaths;
         record.throughputPerSec = duration > 0.0 ? static_cast<double>(record.samplesProcessed) / duration : 0.0;
         record.market = market;
-        record.simulation = sim;
+        record.simulation = engine.config();
         record.optionConfig = opt;
         record.optionResult = result;
 
@@ -763,13 +938,37 @@ private:
                  << "\"timestamp\":\"" << record.timestamp << "\","
                  << "\"durationSeconds\":" << record.durationSeconds << ","
                  << "\"threads\":" << record.threadCount << ","
+                 << "\"simd\":\"" << record.simdLevel << "\","
                  << "\"result\":{"
                  << "\"price\":" << result.price << ","
                  << "\"standardError\":" << result.standardError << ","
-                 << "\"analyticPrice\":" << result.analyticPrice << ","
-                 << "\"relativeError\":" << result.relativeError << ","
-                 << "\"controlVariateWeight\":" << result.controlVariateWeight
-                 << "}"
+                 << "\"analyticPrice\":" << JsonNumber{result.analyticPrice} << ","
+                 << "\"relativeError\":" << JsonNumber{result.relativeError} << ","
+                 << "\"controlVariateWeight\":" << result.controlVariateWeight << ","
+                 << "\"scenarios\":" << result.scenarios;
+        if (result.greeks) {
+            const auto greek = [&](const char* name, const GreekEstimate& estimate) {
+                response << ",\"" << name << "\":{\"value\":" << estimate.value
+                         << ",\"standardError\":" << estimate.standardError << "}";
+            };
+            greek("delta", result.greeks->delta);
+            greek("gamma", result.greeks->gamma);
+            greek("vega", result.greeks->vega);
+            greek("rho", result.greeks->rho);
+        }
+        response << "},"
+                 << "\"chain\":[";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            response << (i > 0 ? "," : "") << "{"
+                     << "\"strike\":" << chain[i].strike << ","
+                     << "\"price\":" << results[i].price << ","
+                     << "\"standardError\":" << results[i].standardError << ","
+                     << "\"analyticPrice\":" << JsonNumber{results[i].analyticPrice} << ","
+                     << "\"relativeError\":" << JsonNumber{results[i].relativeError} << ","
+                     << "\"controlVariateWeight\":" << results[i].controlVariateWeight
+                     << "}";
+        }
+        response << "]"
                  << "}";
 
         const std::string resp = httpResponse(response.str(), "application/json");
@@ -782,6 +981,7 @@ private:
         market.riskFreeRate = getDouble(params, "rate", 0.02);
         market.dividendYield = getDouble(params, "dividend", 0.0);
         market.volatility = getDouble(params, "vol", 0.2);
+        applyModel(params, market);
 
         SimulationConfig sim;
         sim.maturity = getDouble(params, "maturity", 1.0);
@@ -791,10 +991,20 @@ private:
         sim.useAntithetic = getBool(params, "antithetic", true);
         sim.useControlVariate = getBool(params, "control", false);
         sim.blockSize = getSize(params, "block", 4096);
+        sim.threads = getSize(params, "threads", 0);
+        sim.sampling = getSampling(params, "sampling", PathSampling::Auto);
+        sim.precision = getPrecision(params, "precision", PathPrecision::Double);
+        sim.sequence = getSequence(params, "sequence", RandomSequence::PseudoRandom);
+        sim.qmcReplicas = getSize(params, "replicas", sim.qmcReplicas);
+        applyAdaptive(params, sim);
 
         VaRConfig varCfg;
         varCfg.notional = getDouble(params, "notional", 1'000'000.0);
         varCfg.percentile = getDouble(params, "percentile", 0.99);
+        varCfg.streaming = getBool(params, "streaming", false);
+        varCfg.streamingTolerance = getDouble(params, "tolerance", varCfg.streamingTolerance);
+        varCfg.importanceSampling = getBool(params, "importance", false);
+        varCfg.importanceShift = getDouble(params, "shift", 0.0);
 
         const auto start = Clock::now();
         MonteCarloEngine engine(market, sim);
@@ -805,16 +1015,12 @@ private:
         record.command = "var";
         record.timestamp = isoTimestamp(Clock::now());
         record.durationSeconds = duration;
-        record.threadCount =
-#ifdef _OPENMP
-            omp_get_max_threads();
-#else
-            1;
-#endif
-        record.samplesProcessed = sim.paths;
+        record.threadCount = static_cast<int>(result.threads);
+        record.simdLevel = simdLevelName(detectSimdLevel());
+        record.samplesProcessed = result.basePaths;
         record.throughputPerSec = duration > 0.0 ? static_cast<double>(record.samplesProcessed) / duration : 0.0;
         record.market = market;
-        record.simulation = sim;
+        record.simulation = engine.config();
         record.varConfig = varCfg;
         record.varResult = result;
 
@@ -826,12 +1032,17 @@ private:
                  << "\"timestamp\":\"" << record.timestamp << "\","
                  << "\"durationSeconds\":" << record.durationSeconds << ","
                  << "\"threads\":" << record.threadCount << ","
+                 << "\"simd\":\"" << record.simdLevel << "\","
                  << "\"result\":{"
                  << "\"percentile\":" << result.percentile << ","
                  << "\"valueAtRisk\":" << result.valueAtRisk << ","
                  << "\"expectedShortfall\":" << result.expectedShortfall << ","
                  << "\"meanLoss\":" << result.meanLoss << ","
-                 << "\"lossStdDev\":" << result.lossStdDev
+                 << "\"lossStdDev\":" << result.lossStdDev << ","
+                 << "\"errorBound\":" << result.errorBound << ","
+                 << "\"standardError\":" << result.standardError << ","
+                 << "\"scenarios\":" << result.scenarios << ","
+                 << "\"effectiveSampleSize\":" << result.effectiveSampleSize
                  << "}"
                  << "}";
 
@@ -854,6 +1065,7 @@ private:
 int main(int argc, char** argv) {
     try {
         ServerConfig cfg = parseArgs(argc, argv);
+        MonteCarloEngine::calibrateThreading();
 
         HistoricalStore store;
         if (cfg.historicalSymbol && cfg.historicalPath) {
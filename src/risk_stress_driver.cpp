@@ -1,4 +1,6 @@
 #include "monte_carlo_engine.hpp"
+#include "simd_dispatch.hpp"
+#include "task_pool.hpp"
 
 #include <algorithm>
 #include <chrono>
@@ -15,16 +17,15 @@
 #include <thread>
 #include <vector>
 
-#ifdef _OPENMP
-#include <omp.h>
-#endif
-
 namespace {
 
 struct StressConfig {
     std::size_t jobs = std::thread::hardware_concurrency();
     std::size_t iterations = 40;
     std::size_t paths = 400'000;
+    // Per-job thread budget on the shared task pool; 0 splits the pool evenly
+    // across the jobs.
+    std::size_t threadsPerJob = 0;
     bool runVar = true;
 };
 
@@ -38,16 +39,21 @@ StressConfig parseArgs(int argc, char** argv) {
             cfg.iterations = static_cast<std::size_t>(std::stoull(argv[++i]));
         } else if (arg == "--paths" && i + 1 < argc) {
             cfg.paths = static_cast<std::size_t>(std::stoull(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            cfg.threadsPerJob = static_cast<std::size_t>(std::stoull(argv[++i]));
         } else if (arg == "--option-only") {
             cfg.runVar = false;
         } else if (arg == "--help") {
-            std::cout << "Usage: risk_stress [--jobs N] [--iterations N] [--paths N] [--option-only]\n";
+            std::cout << "Usage: risk_stress [--jobs N] [--iterations N] [--paths N] [--threads N] [--option-only]\n";
             std::exit(0);
         } else {
             throw std::invalid_argument("Unknown argument: " + arg);
         }
     }
     cfg.jobs = std::max<std::size_t>(1, cfg.jobs);
+    if (cfg.threadsPerJob == 0) {
+        cfg.threadsPerJob = std::max<std::size_t>(1, TaskPool::shared().concurrency() / cfg.jobs);
+    }
     return cfg;
 }
 
@@ -128,6 +134,7 @@ void stressWorker(const StressConfig& cfg,
         sim.useAntithetic = true;
         sim.useControlVariate = true;
         sim.blockSize = 4096;
+        sim.threads = cfg.threadsPerJob;
 
         OptionConfig optionCfg;
         optionCfg.strike = strikeDist(rng);
@@ -141,12 +148,7 @@ void stressWorker(const StressConfig& cfg,
         RunEntry optionEntry;
         optionEntry.command = "option";
         optionEntry.durationSeconds = std::chrono::duration<double>(endOpt - startOpt).count();
-        optionEntry.threads =
-#ifdef _OPENMP
-            omp_get_max_threads();
-#else
-            1;
-#endif
+        optionEntry.threads = static_cast<int>(optionResult.threads);
         optionEntry.option = OptionStats{optionResult.price, optionResult.standardError, optionResult.analyticPrice};
 
         {
@@ -172,12 +174,7 @@ void stressWorker(const StressConfig& cfg,
         RunEntry varEntry;
         varEntry.command = "var";
         varEntry.durationSeconds = std::chrono::duration<double>(endVar - startVar).count();
-        varEntry.threads =
-#ifdef _OPENMP
-            omp_get_max_threads();
-#else
-            1;
-#endif
+        varEntry.threads = static_cast<int>(varResult.threads);
         varEntry.var = VarStats{varResult.valueAtRisk, varResult.expectedShortfall};
 
         {
@@ -192,9 +189,11 @@ void stressWorker(const StressConfig& cfg,
 int main(int argc, char** argv) {
     try {
         const StressConfig cfg = parseArgs(argc, argv);
+        MonteCarloEngine::calibrateThreading();
 
         std::cout << "[risk_stress] jobs=" << cfg.jobs << " iterations=" << cfg.iterations
-                  << " paths=" << cfg.paths << " runVar=" << std::boolalpha << cfg.runVar << "\n";
+                  << " paths=" << cfg.paths << " threads/job=" << cfg.threadsPerJob
+                  << " simd=" << simdLevelName(detectSimdLevel()) << " runVar=" << std::boolalpha << cfg.runVar << "\n";
 
         std::vector<std::thread> workers;
         std::vector<RunEntry> results;
@@ -0,0 +1,210 @@
+#include "counter_rng.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Checks of the counter generator that need no reference data:
+//   - every block split of a path range gives the same variates, bit for bit;
+//   - the batch kernel agrees with an independent scalar Box-Muller built from
+//     Philox4x32::generate, counterUniform and libm, within a stated tolerance;
+//   - the lane log/sin/cos stay within stated tolerances of libm;
+//   - a million variates have the mean, variance and tail frequencies of N(0, 1).
+// Exits non-zero when any check fails.
+
+namespace {
+
+constexpr double kTwoPi = 6.28318530717958647692;
+
+// Box-Muller on one Philox block with libm throughout, following the counter
+// layout documented on fillCounterNormals but sharing none of its code.
+double referenceNormal(const Philox4x32::Key& key, std::size_t path, std::size_t step, RngStream stream,
+                       std::size_t asset) {
+    const auto pair = static_cast<std::uint64_t>(path / 2);
+    const Philox4x32::Counter counter = {static_cast<std::uint32_t>(pair), static_cast<std::uint32_t>(pair >> 32),
+                                         static_cast<std::uint32_t>(step), counterStreamWord(stream, asset)};
+    const Philox4x32::Counter words = Philox4x32::generate(counter, key);
+    const double radius = std::sqrt(-2.0 * std::log(counterUniform(words[0], words[1])));
+    const double angle = kTwoPi * counterUniform(words[2], words[3]);
+    return path % 2 == 0 ? radius * std::cos(angle) : radius * std::sin(angle);
+}
+
+// The same transform on the 23-bit uniforms of the single-precision generator,
+// evaluated in double.
+double referenceNormalFloat(const Philox4x32::Key& key, std::size_t path, std::size_t step, RngStream stream,
+                            std::size_t asset) {
+    const auto pair = static_cast<std::uint64_t>(path / 2);
+    const Philox4x32::Counter counter = {static_cast<std::uint32_t>(pair), static_cast<std::uint32_t>(pair >> 32),
+                                         static_cast<std::uint32_t>(step), counterStreamWord(stream, asset)};
+    const Philox4x32::Counter words = Philox4x32::generate(counter, key);
+    const double radius = std::sqrt(-2.0 * std::log(static_cast<double>(counterUniformFloat(words[0]))));
+    const double angle = kTwoPi * static_cast<double>(counterUniformFloat(words[2]));
+    return path % 2 == 0 ? radius * std::cos(angle) : radius * std::sin(angle);
+}
+
+bool passed = true;
+
+void report(const char* name, bool ok, const std::string& detail) {
+    std::cout << (ok ? "PASS  " : "FAIL  ") << name << " : " << detail << "\n";
+    passed = passed && ok;
+}
+
+void within(const char* name, double error, double tolerance) {
+    std::ostringstream detail;
+    detail << std::scientific << std::setprecision(2) << "max error " << error << " (tolerance " << tolerance << ")";
+    report(name, error <= tolerance, detail.str());
+}
+
+void checkBlockSplits(const Philox4x32::Key& key) {
+    const std::size_t firstPaths[] = {0, 1, 63, 128, 4095, 1000001};
+    const std::size_t counts[] = {1, 2, 7, 128, 129, 1000};
+    const std::size_t steps[] = {0, 5};
+    const std::size_t assets[] = {0, 3};
+    std::size_t checked = 0;
+    std::size_t mismatches = 0;
+    std::size_t floatMismatches = 0;
+    double referenceError = 0.0;
+    double floatReferenceError = 0.0;
+    for (std::size_t firstPath : firstPaths) {
+        for (std::size_t count : counts) {
+            for (std::size_t step : steps) {
+                for (std::size_t asset : assets) {
+                    // One call, the same range split into three uneven blocks, and
+                    // one call per variate.
+                    std::vector<double> whole(count);
+                    std::vector<double> split(count);
+                    std::vector<float> wholeFloat(count);
+                    std::vector<float> splitFloat(count);
+                    fillCounterNormals(key, firstPath, step, RngStream::PathShock, count, whole.data(), asset);
+                    fillCounterNormals(key, firstPath, step, RngStream::PathShock, count, wholeFloat.data(), asset);
+                    const std::size_t cut1 = count / 3;
+                    const std::size_t cut2 = cut1 + (count - cut1) / 2 + 1;
+                    const std::size_t cuts[] = {0, cut1, std::min(cut2, count), count};
+                    for (std::size_t b = 0; b + 1 < 4; ++b) {
+                        fillCounterNormals(key, firstPath + cuts[b], step, RngStream::PathShock,
+                                           cuts[b + 1] - cuts[b], split.data() + cuts[b], asset);
+                        fillCounterNormals(key, firstPath + cuts[b], step, RngStream::PathShock,
+                                           cuts[b + 1] - cuts[b], splitFloat.data() + cuts[b], asset);
+                    }
+                    for (std::size_t i = 0; i < count; ++i) {
+                        const std::size_t path = firstPath + i;
+                        const double single = counterNormal(key, path, step, RngStream::PathShock, asset);
+                        mismatches += whole[i] != split[i] || whole[i] != single;
+                        floatMismatches += wholeFloat[i] != splitFloat[i];
+
+                        const double reference = referenceNormal(key, path, step, RngStream::PathShock, asset);
+                        referenceError =
+                            std::max(referenceError, std::abs(whole[i] - reference) / std::max(1.0, std::abs(reference)));
+                        const double floatReference =
+                            referenceNormalFloat(key, path, step, RngStream::PathShock, asset);
+                        floatReferenceError = std::max(
+                            floatReferenceError, std::abs(static_cast<double>(wholeFloat[i]) - floatReference) /
+                                                     std::max(1.0, std::abs(floatReference)));
+                        ++checked;
+                    }
+                }
+            }
+        }
+    }
+    report("block splits (double)", mismatches == 0,
+           std::to_string(mismatches) + " of " + std::to_string(checked) + " variates differ between splits");
+    report("block splits (float)", floatMismatches == 0,
+           std::to_string(floatMismatches) + " of " + std::to_string(checked) + " variates differ between splits");
+    // Errors relative to max(1, |z|): the lane log and sin/cos are within a few
+    // ulps of libm, and the radius multiplies the angle's error by at most ~6.
+    within("double normals vs scalar libm Box-Muller", referenceError, 1e-14);
+    within("float normals vs scalar libm Box-Muller", floatReferenceError, 1e-6);
+}
+
+void checkLaneMath() {
+    using namespace counter_rng_detail;
+    constexpr int kSamples = 1 << 20;
+    double sinError = 0.0;
+    double cosError = 0.0;
+    double logError = 0.0;
+    double sinErrorFloat = 0.0;
+    double cosErrorFloat = 0.0;
+    double logErrorFloat = 0.0;
+    for (int i = 0; i < kSamples; ++i) {
+        const double u = (static_cast<double>(i) + 0.5) / kSamples;
+        double c = 0.0;
+        double s = 0.0;
+        batchSinCosTurn(u, c, s);
+        sinError = std::max(sinError, std::abs(s - std::sin(kTwoPi * u)));
+        cosError = std::max(cosError, std::abs(c - std::cos(kTwoPi * u)));
+        logError = std::max(logError, std::abs(batchLog(u) / std::log(u) - 1.0));
+
+        const auto uf = static_cast<float>(u);
+        float cf = 0.0f;
+        float sf = 0.0f;
+        batchSinCosTurnFloat(uf, cf, sf);
+        const double angle = kTwoPi * static_cast<double>(uf);
+        sinErrorFloat = std::max(sinErrorFloat, std::abs(static_cast<double>(sf) - std::sin(angle)));
+        cosErrorFloat = std::max(cosErrorFloat, std::abs(static_cast<double>(cf) - std::cos(angle)));
+        logErrorFloat = std::max(
+            logErrorFloat, std::abs(static_cast<double>(batchLogFloat(uf)) / std::log(static_cast<double>(uf)) - 1.0));
+    }
+    within("sin(2 pi u) vs std::sin", sinError, 2e-15);
+    within("cos(2 pi u) vs std::cos", cosError, 2e-15);
+    within("log(u) vs std::log, relative", logError, 1e-15);
+    within("float sin(2 pi u) vs std::sin", sinErrorFloat, 5e-7);
+    within("float cos(2 pi u) vs std::cos", cosErrorFloat, 5e-7);
+    within("float log(u) vs std::log, relative", logErrorFloat, 1e-6);
+}
+
+// Sample mean, variance and two-sided tail frequencies of n variates, each
+// against N(0, 1) within five of its standard errors.
+template <typename Scalar>
+void checkDistribution(const char* label, const Philox4x32::Key& key) {
+    constexpr std::size_t kVariates = std::size_t{1} << 20;
+    std::vector<Scalar> normals(kVariates);
+    fillCounterNormals(key, 0, 0, RngStream::PathShock, kVariates, normals.data());
+
+    double sum = 0.0;
+    double sumSq = 0.0;
+    std::size_t beyond2 = 0;
+    std::size_t beyond3 = 0;
+    for (const Scalar z : normals) {
+        const auto x = static_cast<double>(z);
+        sum += x;
+        sumSq += x * x;
+        beyond2 += std::abs(x) > 2.0;
+        beyond3 += std::abs(x) > 3.0;
+    }
+    const auto n = static_cast<double>(kVariates);
+    const double mean = sum / n;
+    const double variance = sumSq / n - mean * mean;
+    const auto frequency = [&](std::size_t count, double expected) {
+        const double observed = static_cast<double>(count) / n;
+        return std::abs(observed - expected) / std::sqrt(expected * (1.0 - expected) / n);
+    };
+    const auto sigmas = [](const char* name, double deviations) {
+        std::ostringstream detail;
+        detail << std::fixed << std::setprecision(2) << deviations << " standard errors from N(0, 1) (limit 5)";
+        report(name, deviations <= 5.0, detail.str());
+    };
+    const std::string prefix = std::string(label) + " ";
+    sigmas((prefix + "mean").c_str(), std::abs(mean) * std::sqrt(n));
+    sigmas((prefix + "variance").c_str(), std::abs(variance - 1.0) / std::sqrt(2.0 / n));
+    sigmas((prefix + "P(|z| > 2)").c_str(), frequency(beyond2, std::erfc(2.0 / std::sqrt(2.0))));
+    sigmas((prefix + "P(|z| > 3)").c_str(), frequency(beyond3, std::erfc(3.0 / std::sqrt(2.0))));
+}
+
+}  // namespace
+
+int main() {
+    const Philox4x32::Key key = counterRngKey(42);
+    checkBlockSplits(key);
+    checkLaneMath();
+    checkDistribution<double>("double", key);
+    checkDistribution<float>("float", key);
+
+    std::cout << (passed ? "counter RNG checks passed\n" : "counter RNG checks FAILED\n");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+#include "path_kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Checks of every path-kernel table the CPU can run:
+//   - each kernel agrees with a scalar libm evaluation within a stated tolerance
+//     (the intrinsic exactly);
+//   - a value's result does not depend on where it sits in the block, so any
+//     block split gives the same output bit for bit;
+//   - the AVX2 and AVX-512 tables stay within a few ulps of the baseline table.
+// Tables whose unit was built without its ISA flags are reported as skipped.
+// Exits non-zero when any check fails.
+
+namespace {
+
+bool passed = true;
+
+void report(const std::string& name, bool ok, const std::string& detail) {
+    std::cout << (ok ? "PASS  " : "FAIL  ") << name << " : " << detail << "\n";
+    passed = passed && ok;
+}
+
+void within(const std::string& name, double error, double tolerance) {
+    std::ostringstream detail;
+    detail << std::scientific << std::setprecision(2) << "max error " << error << " (tolerance " << tolerance << ")";
+    report(name, error <= tolerance, detail.str());
+}
+
+double relative(double value, double reference) {
+    return std::abs(value - reference) / std::max(1e-300, std::abs(reference));
+}
+
+constexpr std::size_t kValues = 4099;
+
+struct Inputs {
+    std::vector<double> x;
+    std::vector<float> xFloat;
+};
+
+// Stand-ins for summed shocks and basket log returns: the arguments span
+// [-40, 40], far wider than any path reaches.
+Inputs makeInputs() {
+    Inputs in{std::vector<double>(kValues), std::vector<float>(kValues)};
+    for (std::size_t i = 0; i < kValues; ++i) {
+        in.x[i] = 40.0 * std::sin(0.7 * static_cast<double>(i) + 0.3) * std::cos(0.013 * static_cast<double>(i));
+        in.xFloat[i] = static_cast<float>(in.x[i]);
+    }
+    return in;
+}
+
+struct Outputs {
+    std::vector<double> exp;
+    std::vector<double> expFloat;
+    std::vector<double> returns;
+    std::vector<double> call;
+    std::vector<double> put;
+};
+
+constexpr double kScale = 100.0;
+constexpr double kOffset = 0.013;
+constexpr double kSlope = 0.2;
+constexpr double kWeight = 0.35;
+constexpr double kStrike = 100.0;
+constexpr double kDiscount = 0.951229424500714;
+
+// Runs every kernel of the table on x[first, first + count) into out's slice.
+void run(const PathKernels& kernels, const Inputs& in, std::size_t first, std::size_t count, Outputs& out) {
+    const std::vector<double>& x = in.x;
+    const std::vector<float>& xFloat = in.xFloat;
+    kernels.scaledExp(x.data() + first, count, kScale, kOffset, kSlope, out.exp.data() + first);
+    kernels.scaledExpFloat(xFloat.data() + first, count, static_cast<float>(kScale), static_cast<float>(kOffset),
+                           static_cast<float>(kSlope), out.expFloat.data() + first);
+    kernels.accumulateReturn(x.data() + first, count, kOffset, kWeight, out.returns.data() + first);
+    kernels.discountedIntrinsic(out.exp.data() + first, count, kStrike, true, kDiscount, out.call.data() + first);
+    kernels.discountedIntrinsic(out.exp.data() + first, count, kStrike, false, kDiscount, out.put.data() + first);
+}
+
+// The kernels over consecutive blocks ending at the given cuts; the return
+// accumulator starts at 0.5 everywhere.
+Outputs evaluate(const PathKernels& kernels, const Inputs& in, const std::vector<std::size_t>& cuts) {
+    Outputs out{std::vector<double>(kValues), std::vector<double>(kValues), std::vector<double>(kValues, 0.5),
+                std::vector<double>(kValues), std::vector<double>(kValues)};
+    for (std::size_t b = 0; b + 1 < cuts.size(); ++b) {
+        run(kernels, in, cuts[b], cuts[b + 1] - cuts[b], out);
+    }
+    return out;
+}
+
+std::size_t mismatches(const Outputs& a, const Outputs& b) {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < a.exp.size(); ++i) {
+        count += a.exp[i] != b.exp[i] || a.expFloat[i] != b.expFloat[i] || a.returns[i] != b.returns[i] ||
+                 a.call[i] != b.call[i] || a.put[i] != b.put[i];
+    }
+    return count;
+}
+
+void checkTable(const char* label, const PathKernels& kernels, const Inputs& in, const Outputs* baseline) {
+    const std::vector<double>& x = in.x;
+    const std::vector<float>& xFloat = in.xFloat;
+    const Outputs whole = evaluate(kernels, in, {0, kValues});
+    const Outputs split = evaluate(kernels, in, {0, 1, 18, 33, 1000, 1001, 4096, kValues});
+    const std::string prefix = std::string(label) + " ";
+    report(prefix + "block splits", mismatches(whole, split) == 0,
+           std::to_string(mismatches(whole, split)) + " of " + std::to_string(kValues) + " values differ");
+
+    double expError = 0.0;
+    double floatError = 0.0;
+    double returnError = 0.0;
+    std::size_t intrinsicMismatches = 0;
+    for (std::size_t i = 0; i < kValues; ++i) {
+        expError = std::max(expError, relative(whole.exp[i], kScale * std::exp(kOffset + kSlope * x[i])));
+        const double floatArgument = static_cast<double>(static_cast<float>(kOffset)) +
+                                     static_cast<double>(static_cast<float>(kSlope)) * static_cast<double>(xFloat[i]);
+        floatError = std::max(floatError, relative(whole.expFloat[i], kScale * std::exp(floatArgument)));
+        const double expected = 0.5 + kWeight * (std::exp(x[i] + kOffset) - 1.0);
+        returnError = std::max(returnError, std::abs(whole.returns[i] - expected) / std::max(1.0, std::abs(expected)));
+        intrinsicMismatches += whole.call[i] != kDiscount * std::max(whole.exp[i] - kStrike, 0.0) ||
+                               whole.put[i] != kDiscount * std::max(kStrike - whole.exp[i], 0.0);
+    }
+    // exp is within a couple of ulps; the rounding of an argument of up to ~8
+    // (|a| * 2^-53 relative in the result) dominates, and whether it is rounded
+    // depends on FMA. The float kernel carries float rounding of both.
+    within(prefix + "scaledExp vs std::exp, relative", expError, 4e-15);
+    within(prefix + "scaledExpFloat vs std::exp, relative", floatError, 2e-6);
+    within(prefix + "accumulateReturn vs std::exp", returnError, 1e-15);
+    report(prefix + "discountedIntrinsic", intrinsicMismatches == 0,
+           std::to_string(intrinsicMismatches) + " of " + std::to_string(kValues) + " values differ");
+
+    if (baseline == nullptr) {
+        return;
+    }
+    double expGap = 0.0;
+    double floatGap = 0.0;
+    for (std::size_t i = 0; i < kValues; ++i) {
+        expGap = std::max(expGap, relative(whole.exp[i], baseline->exp[i]));
+        floatGap = std::max(floatGap, relative(whole.expFloat[i], baseline->expFloat[i]));
+    }
+    within(prefix + "scaledExp vs baseline table, relative", expGap, 4e-15);
+    within(prefix + "scaledExpFloat vs baseline table, relative", floatGap, 1e-6);
+}
+
+}  // namespace
+
+int main() {
+    using namespace path_kernels_detail;
+    const Inputs in = makeInputs();
+    checkTable("baseline", baselineKernels(), in, nullptr);
+    const Outputs reference = evaluate(baselineKernels(), in, {0, kValues});
+
+    const SimdLevel cpu = detectSimdLevel();
+    const struct {
+        const char* label;
+        const PathKernels* kernels;
+        SimdLevel level;
+    } tables[] = {{"avx2", avx2Kernels(), SimdLevel::Avx2}, {"avx512", avx512Kernels(), SimdLevel::Avx512}};
+    for (const auto& table : tables) {
+        if (table.kernels == nullptr) {
+            std::cout << "SKIP  " << table.label << " : unit built without its ISA flags\n";
+        } else if (cpu < table.level) {
+            std::cout << "SKIP  " << table.label << " : not supported by this CPU\n";
+        } else {
+            checkTable(table.label, *table.kernels, in, &reference);
+        }
+    }
+    std::cout << "dispatched: " << simdLevelName(pathKernels().level) << "\n";
+
+    std::cout << (passed ? "path kernel checks passed\n" : "path kernel checks FAILED\n");
+    return passed ? 0 : 1;
+}